@@ -6,7 +6,7 @@
 
 #define CIRCLE_RADIUS 1
 
-static int circle_hits = 0;
+static long long circle_hits = 0;
 
 
 int 
@@ -20,7 +20,7 @@ main (int argc, char** argv)
    }
    
   unsigned int num_threads;
-  unsigned int num_samples;
+  unsigned long long num_samples;
   
   if (sscanf (argv[1],"%u",&num_threads) != 1)
   {
@@ -28,23 +28,39 @@ main (int argc, char** argv)
     return 1;
   }
   
-  if (sscanf (argv[2],"%u",&num_samples) != 1)
+  if (sscanf (argv[2],"%llu",&num_samples) != 1)
   {
     fprintf (stderr, "<number_samples> has to be a positive integer\n");
     return 1;
   }
   
-  int k;
-  #pragma omp parallel for schedule(static) private(k) reduction(+:circle_hits) num_threads(num_threads)
-  for (k = 0; k < num_samples; k++)
-  {  
-    double x = pr_random_f(CIRCLE_RADIUS);
-    double y = pr_random_f(CIRCLE_RADIUS);
+  #pragma omp parallel reduction(+:circle_hits) num_threads(num_threads)
+  {
+    pr_pcg_state random_state;
+    long long next_sample = -1;
+    long long k;
+
+    #pragma omp for schedule(static)
+    for (k = 0; k < num_samples; k++)
+    {  
+      // sample k uses the numbers 2k and 2k + 1 of the sequence: at the
+      // start of each chunk of this thread the private state jumps there,
+      // so the hits do not depend on the number of threads
+      if (k != next_sample)
+      {
+        pr_pcg_seed(&random_state, PR_PCG_SEED, PR_PCG_STREAM);
+        pr_pcg_skip(&random_state, 2 * (unsigned long long) k);
+      }
+      next_sample = k + 1;
+
+      double x = pr_pcg_f_r(&random_state, CIRCLE_RADIUS);
+      double y = pr_pcg_f_r(&random_state, CIRCLE_RADIUS);
  
-    if (((x * x) + (y * y)) <= 1)
-    {
-      circle_hits++;
-    } 
+      if (((x * x) + (y * y)) <= 1)
+      {
+        circle_hits++;
+      } 
+    }
   }
   
   /*#pragma omp parallel num_threads(num_threads)
@@ -52,7 +68,7 @@ main (int argc, char** argv)
     printf ("number of parallel threads: %d\n", omp_get_num_threads());
   }*/
   
-  double pi = ((double) circle_hits / num_samples) * 4;
+  double pi = ((double) circle_hits / (double) num_samples) * 4;
   printf ("estimation of pi: %f\n", pi);
 
   double relative_error = ((pi - M_PI) / M_PI);
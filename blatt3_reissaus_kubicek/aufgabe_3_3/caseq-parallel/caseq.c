@@ -5,27 +5,45 @@
  * #1: Number of lines
  * #2: Number of iterations to be simulated
  *
+ * options:
+ * -S n               write a snapshot of the field every n iterations
+ * -o prefix          snapshot files are named prefix.<rank>
+ *                    (default "snapshot")
+ * -O file            write population, density and number of changed
+ *                    cells of every iteration to the CSV file
+ * -i                 update the lines of a rank in place (one buffer
+ *                    plus a few lines instead of two buffers)
+ * -w format          wire format of the ghost zone lines: raw (default),
+ *                    packed (one bit per cell) or delta (changed words
+ *                    of the packed line since the previous iteration)
+ * -v mode            verification: md5 (default) gathers the field to
+ *                    rank 0, tree reduces the tree hashes of the ranks
+ *                    (see treehash.h) without moving the field
+ * -D file            tree mode: write the digest of every line to file
+ * -k kernel          line kernel: naive (default) sums the nine cells of
+ *                    every neighbourhood, separable sums every column once
+ *                    and slides a window over the column sums
+ *
  */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <assert.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
 
 #include "random.h"
 #include "md5tool.h"
+#include "caseq.h"
+#include "snapshot.h"
+#include "observables.h"
+#include "halo.h"
+#include "treehash.h"
+#include "perfcount.h"
 #include <mpi.h>
 
-/* size of ghostzone (one line for upper and lower region each) */
-#define GHOSTZONE_SIZE 1
-
-/* horizontal size of the configuration */
-#define XSIZE 1024
-
-/* "ADT" State and line of states (plus border) */
-typedef char State;
-typedef State Line[XSIZE + 2];
-
 /* determine random integer between 0 and n-1 */
 #define randInt(n) ((int)(nextRandomLEcuyer() * n))
 
@@ -46,12 +64,12 @@ void print_line(Line line, int index)
 
 
 /* random starting configuration */
-static void initConfig(Line *buf, int lines, int rem_lines, int my_lines, int my_rank)
+static void initConfig(Line *buf, long long lines, long long rem_lines, int my_lines, int my_rank)
 {
     int x, y;
 
     initRandomLEcuyer(424243);
-    int no_rands = 0;
+    long long no_rands = 0;
 
     /* calculate how often the random function was called before */
     if (my_rank <= rem_lines)
@@ -64,7 +82,7 @@ static void initConfig(Line *buf, int lines, int rem_lines, int my_lines, int my
                    (my_rank - rem_lines) * lines * XSIZE;
     }
 
-    int i;
+    long long i;
     long randResult = 0;
     for (i = 0; i < no_rands; i++)
     {
@@ -109,29 +127,132 @@ static void boundary_left_right(Line *buf, int lines)
 
 }
 
+/* use update_row_separable instead of the nine cell sums */
+static int separable = 0;
+
+/* the sum of the three cells of column x is calculated once and used
+ * for the cells x - 1, x and x + 1: the neighbourhood sum is a running
+ * sum over the column sums, the entering column is added and the
+ * leaving one subtracted.
+ */
+static void update_row_separable(State *up, State *mid, State *down, State *out, long long *counts)
+{
+    unsigned int column[XSIZE + 2];
+    unsigned int sum, population = 0, changed = 0;
+    int x;
+
+    for (x = 0;  x <= XSIZE + 1;  x++)
+    {
+        column[x] = up[x] + mid[x] + down[x];
+    }
+
+    sum = column[0] + column[1];
+    for (x = 1;  x <= XSIZE;  x++)
+    {
+        sum += column[x + 1];
+        out[x] = anneal[sum];
+        sum -= column[x - 1];
+    }
+
+    if (counts)
+    {
+        for (x = 1;  x <= XSIZE;  x++)
+        {
+            population += out[x];
+            changed += out[x] ^ mid[x];
+        }
+
+        counts[OBS_POPULATION] += population;
+        counts[OBS_CHANGED] += changed;
+    }
+}
+
+/* calculate the new line out from the old lines up, mid and down.
+ * if counts is given, the nonzero and the changed cells of the new line
+ * are added to it in the same pass.
+ */
+static void update_row(State *up, State *mid, State *down, State *out, long long *counts)
+{
+    int x;
+    unsigned int population = 0, changed = 0;
+    State *rows[3];
+
+    if (separable)
+    {
+        update_row_separable(up, mid, down, out, counts);
+        return;
+    }
+
+    rows[0] = up;
+    rows[1] = mid;
+    rows[2] = down;
+
+    if (!counts)
+    {
+        for (x = 1;  x <= XSIZE;  x++)
+        {
+            out[x  ] = transition(rows, x  , 1);
+        }
+        return;
+    }
+
+    for (x = 1;  x <= XSIZE;  x++)
+    {
+        State state = transition(rows, x  , 1);
+
+        out[x  ] = state;
+        population += state;
+        changed += state ^ mid[x];
+    }
+
+    counts[OBS_POPULATION] += population;
+    counts[OBS_CHANGED] += changed;
+}
+
+/* calculate line y of the new configuration */
+static void update_line(Line *from, Line *to, int y, long long *counts)
+{
+    update_row(from[y - 1], from[y], from[y + 1], to[y], counts);
+}
+
+/* The result of iteration i is written to the buffer that held the
+ * configuration of iteration i - 1, so its border columns are the ones
+ * boundary_left_right() calculated one iteration earlier; they are part
+ * of the hash. The in-place update saves them in columns and restores
+ * them at the end.
+ */
+static void save_columns(Line *buf, int lines, State (*columns)[2])
+{
+    int y;
+
+    for (y = 1;  y <= lines;  y++)
+    {
+        columns[y - 1][0] = buf[y][0        ];
+        columns[y - 1][1] = buf[y][XSIZE + 1];
+    }
+}
+
+static void restore_columns(Line *buf, int lines, State (*columns)[2])
+{
+    int y;
+
+    for (y = 1;  y <= lines;  y++)
+    {
+        buf[y][0        ] = columns[y - 1][0];
+        buf[y][XSIZE + 1] = columns[y - 1][1];
+    }
+}
+
 /* make one simulation iteration with lines lines.
  * old configuration is in from, new one is written to to.
+ * counts (may be NULL) accumulates the observables of the new configuration.
  */
-static void simulate(Line *from, Line *to, int my_lines, int my_rank, int world_size)
+static void simulate(Line *from, Line *to, int my_lines, Halo *halo, long long *counts)
 {
-    int x, y;
+    int y;
     boundary_left_right(from, my_lines);
 
-    MPI_Request reqs[4];
-
-    int top_neighbour_rank = (my_rank == 0) ? world_size - 1 : my_rank - 1;
-    int bottom_neighbour_rank = (my_rank + 1) % world_size;
-
-    /* receive ghost zones */
-    /* receive top ghost zone */
-    MPI_Irecv(from[0], sizeof(Line), MPI_CHAR, top_neighbour_rank, 1,  MPI_COMM_WORLD, &reqs[2]);
-    /* receive bottom ghost zone */
-    MPI_Irecv(from[my_lines + 1], sizeof(Line), MPI_CHAR, bottom_neighbour_rank, 0,  MPI_COMM_WORLD, &reqs[3]);
-    
-    /* send top line */
-    MPI_Isend(from[1], sizeof(Line), MPI_CHAR, top_neighbour_rank, 0, MPI_COMM_WORLD, &reqs[0]);
-    /* send bottom line */
-    MPI_Isend(from[my_lines], sizeof(Line), MPI_CHAR, bottom_neighbour_rank, 1, MPI_COMM_WORLD, &reqs[1]);
+    haloStart(halo, from, my_lines);
 
     /* calculate inner field if present (when more than 2 my_lines) */
     if (my_lines > 2 )
@@ -141,51 +262,330 @@ static void simulate(Line *from, Line *to, int my_lines, int my_rank, int world_
 
         for (y = inner_field_start;  y <= inner_field_end;  y++)
         {
-            for (x = 1;  x <= XSIZE;  x++)
-            {
-                to[y][x  ] = transition(from, x  , y);
-            }
+            update_line(from, to, y, counts);
         }
     }
 
    
-    MPI_Waitall(4, reqs, MPI_STATUSES_IGNORE);
+    haloFinish(halo, from, my_lines);
 
     /* calculate outer field (bottom and top line with help of received ghost zones) */
     int top_line_index = 1;
     int bottom_line_index = my_lines;
 
-    for (x = 1;  x <= XSIZE;  x++)
+    update_line(from, to, top_line_index, counts);
+
+    if (bottom_line_index != top_line_index)
     {
-        to[top_line_index][x  ] = transition(from, x  , top_line_index);
+        update_line(from, to, bottom_line_index, counts);
     }
+}
 
-    if (bottom_line_index != top_line_index)
+/* lines of the rolling buffer of simulate_in_place */
+#define ROLL_PENDING 0   /* two new inner lines not yet written back */
+#define ROLL_SAVED   2   /* old line 2, needed for the top line */
+#define ROLL_TOP     3   /* new top line */
+#define ROLL_BOTTOM  4   /* new bottom line */
+#define ROLL_LINES   5
+
+/* make one simulation iteration in place.
+ * the new inner line y is kept in the rolling buffer until line y + 1,
+ * which still needs the old line y, has been calculated. The top and
+ * bottom line are sent while the inner field is updated, so they are
+ * written back last.
+ * if columns is given, the border columns are saved to it.
+ */
+static void simulate_in_place(Line *buf, Line *rows, int my_lines, Halo *halo,
+                              long long *counts, State (*columns)[2])
+{
+    int y;
+
+    boundary_left_right(buf, my_lines);
+
+    if (columns)
     {
-        for (x = 1;  x <= XSIZE;  x++)
+        save_columns(buf, my_lines, columns);
+    }
+
+    haloStart(halo, buf, my_lines);
+
+    /* calculate inner field if present (when more than 2 my_lines) */
+    if (my_lines > 2)
+    {
+        memcpy(rows[ROLL_SAVED], buf[2], sizeof(Line));
+
+        for (y = 2;  y <= my_lines - 1;  y++)
+        {
+            update_row(buf[y - 1], buf[y], buf[y + 1], rows[ROLL_PENDING + (y & 1)], counts);
+
+            if (y > 2)
+            {
+                memcpy(&buf[y - 1][1], &rows[ROLL_PENDING + ((y - 1) & 1)][1], XSIZE * sizeof(State));
+            }
+        }
+    }
+
+    haloFinish(halo, buf, my_lines);
+
+    /* calculate outer field, line 2 has been overwritten if it is an inner line */
+    update_row(buf[0], buf[1], (my_lines > 2) ? rows[ROLL_SAVED] : buf[2], rows[ROLL_TOP], counts);
+
+    if (my_lines > 1)
+    {
+        update_row(buf[my_lines - 1], buf[my_lines], buf[my_lines + 1], rows[ROLL_BOTTOM], counts);
+    }
+
+    if (my_lines > 2)
+    {
+        memcpy(&buf[my_lines - 1][1], &rows[ROLL_PENDING + ((my_lines - 1) & 1)][1], XSIZE * sizeof(State));
+    }
+
+    memcpy(&buf[1][1], &rows[ROLL_TOP][1], XSIZE * sizeof(State));
+
+    if (my_lines > 1)
+    {
+        memcpy(&buf[my_lines][1], &rows[ROLL_BOTTOM][1], XSIZE * sizeof(State));
+    }
+}
+
+
+/* --------------------- verification --------------------------------- */
+
+/* largest message of gather_ordered */
+#define GATHER_CHUNK (1 << 24)
+#define GATHER_TAG 2
+
+typedef void (*Consumer)(void *data, size_t bytes, void *arg);
+
+/* rank 0 passes the data of all ranks (counts[r] items of size bytes
+ * each) to consume in rank order. The data is sent in messages of at
+ * most GATHER_CHUNK bytes, so neither the MPI counts nor the memory of
+ * rank 0 grow with the size of the field.
+ */
+static void gather_ordered(void *data, long long count, size_t size, int my_rank, int world_size,
+                           const long long *counts, Consumer consume, void *arg)
+{
+    size_t chunk = (GATHER_CHUNK / size) * size;
+    size_t bytes, n;
+    char *ptr, *buffer;
+    int r;
+
+    if (my_rank != 0)
+    {
+        ptr = (char *) data;
+        for (bytes = count * size;  bytes > 0;  bytes -= n, ptr += n)
         {
-            to[bottom_line_index][x  ] = transition(from, x  , bottom_line_index);
+            n = (bytes < chunk) ? bytes : chunk;
+            MPI_Send(ptr, (int) n, MPI_BYTE, 0, GATHER_TAG, MPI_COMM_WORLD);
         }
+        return;
+    }
+
+    consume(data, count * size, arg);
+
+    buffer = malloc(chunk);
+    if (!buffer)
+    {
+      printf("Error allocating requested memory.\n");
+      exit(1);
+    }
 
+    for (r = 1;  r < world_size;  r++)
+    {
+        for (bytes = counts[r] * size;  bytes > 0;  bytes -= n)
+        {
+            n = (bytes < chunk) ? bytes : chunk;
+            MPI_Recv(buffer, (int) n, MPI_BYTE, r, GATHER_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            consume(buffer, n, arg);
+        }
     }
+
+    free(buffer);
+}
+
+static void consume_md5(void *data, size_t bytes, void *arg)
+{
+    md5Add((MD5Stream *) arg, data, bytes);
+}
+
+typedef struct
+{
+    FILE *file;
+    long long line;
+} DigestFile;
+
+static void consume_digests(void *data, size_t bytes, void *arg)
+{
+    DigestFile *out = (DigestFile *) arg;
+    uint64_t *digests = (uint64_t *) data;
+    size_t i;
+
+    for (i = 0;  i < bytes / sizeof(uint64_t);  i++)
+    {
+        fprintf(out->file, "%lld %016llX\n", ++out->line, (unsigned long long) digests[i]);
+    }
+}
+
+/* reduction operator of tree hashes: inout = in || inout, where in comes
+ * from the lower ranks (the operator is not commutative) */
+static void tree_hash_op(void *in, void *inout, int *len, MPI_Datatype *type)
+{
+    TreeHash *left = (TreeHash *) in;
+    TreeHash *right = (TreeHash *) inout;
+    int i;
+
+    (void) type;
+
+    for (i = 0;  i < *len;  i++)
+    {
+        TreeHash tree = left[i];
+
+        treeHashCombine(&tree, &right[i]);
+        right[i] = tree;
+    }
+}
+
+/* hash the lines of every rank and reduce the tree hashes to rank 0.
+ * if digest_name is given, only the line digests are gathered to rank 0
+ * and written to that file, so two runs can be compared line by line.
+ */
+static void tree_verify(Line *buf, int my_lines, int my_rank, int world_size,
+                        long long *line_counts, const char *digest_name)
+{
+    TreeHash local, root;
+    uint64_t *digests;
+    DigestFile out = {NULL, 0};
+    MPI_Datatype tree_type;
+    MPI_Op tree_op;
+    int y;
+
+    digests = malloc(my_lines * sizeof(uint64_t));
+    if (!digests)
+    {
+      printf("Error allocating requested memory.\n");
+      exit(1);
+    }
+
+    treeHashInit(&local);
+    for (y = 1;  y <= my_lines;  y++)
+    {
+        digests[y - 1] = lineDigest(buf[y]);
+        treeHashAddLine(&local, digests[y - 1]);
+    }
+
+    MPI_Type_contiguous(2, MPI_UINT64_T, &tree_type);
+    MPI_Type_commit(&tree_type);
+    MPI_Op_create(tree_hash_op, 0, &tree_op);
+
+    MPI_Reduce(&local, &root, 1, tree_type, tree_op, 0, MPI_COMM_WORLD);
+
+    if (my_rank == 0)
+    {
+        printf("%016llX\n", (unsigned long long) root.hash);
+    }
+
+    if (digest_name)
+    {
+        if (my_rank == 0 && !(out.file = fopen(digest_name, "w")))
+        {
+            printf("Error opening %s.\n", digest_name);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+
+        gather_ordered(digests, my_lines, sizeof(uint64_t), my_rank, world_size,
+                       line_counts, consume_digests, &out);
+
+        if (out.file)
+        {
+            fclose(out.file);
+        }
+    }
+
+    MPI_Op_free(&tree_op);
+    MPI_Type_free(&tree_type);
+    free(digests);
 }
 
 
 /* --------------------- measurement ---------------------------------- */
 
+/* parse a count between min and max, returns 0 on success */
+static int parse_count(const char *str, long long min, long long max, long long *value)
+{
+    char *end;
+
+    errno = 0;
+    *value = strtoll(str, &end, 10);
+
+    return (errno != 0 || end == str || *end != '\0' || *value < min || *value > max);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: caseq [-S interval] [-o prefix] [-O csv] [-i] [-w format] [-v md5|tree] [-D file]\n"
+                    "             [-k naive|separable] <lines> <its>\n");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+}
+
 int main(int argc, char **argv)
 {
-    int lines_global, its, i, *line_counts, *line_displ;
+    long long lines_global, its_arg, *line_counts, *line_displ;
+    int its, i;
     Line *from, *to, *temp;
-    Line *result;
     char *hash = NULL;
+    int opt, provided, snapshot_interval = 0;
+    char *snapshot_prefix = "snapshot";
+    SnapshotStream *snapshots = NULL;
+    char *observables_name = NULL;
+    Observables observables;
+    int in_place = 0;
+    Line rows[ROLL_LINES];
+    State (*columns)[2] = NULL;
+    int wire_format = HALO_RAW;
+    Halo halo;
+    int tree_mode = 0;
+    char *digest_name = NULL;
+
+    /* only the main thread calls MPI, the snapshot thread does file I/O */
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    if (provided < MPI_THREAD_FUNNELED)
+    {
+        fprintf(stderr, "caseq: the MPI library does not support threads\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
 
-    assert(argc == 3);
+    while ((opt = getopt(argc, argv, "S:o:O:iw:v:D:k:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'S': snapshot_interval = atoi(optarg); break;
+            case 'o': snapshot_prefix = optarg; break;
+            case 'O': observables_name = optarg; break;
+            case 'i': in_place = 1; break;
+            case 'w': wire_format = haloFormat(optarg); break;
+            case 'v': tree_mode = (strcmp(optarg, "tree") == 0);
+                      if (!tree_mode && strcmp(optarg, "md5") != 0) usage();
+                      break;
+            case 'D': digest_name = optarg; break;
+            case 'k': separable = (strcmp(optarg, "separable") == 0);
+                      if (!separable && strcmp(optarg, "naive") != 0) usage();
+                      break;
+            default: usage();
+        }
+    }
 
-    MPI_Init(&argc, &argv);
+    if (argc - optind != 2 || snapshot_interval < 0 || wire_format < 0)
+    {
+        usage();
+    }
 
-    lines_global = atoi(argv[1]);
-    its = atoi(argv[2]);
+    if (parse_count(argv[optind], 1, LLONG_MAX / (2 * sizeof(Line)), &lines_global) ||
+        parse_count(argv[optind + 1], 0, INT_MAX, &its_arg))
+    {
+        fprintf(stderr, "<lines> has to be positive, <its> a non-negative integer\n");
+        usage();
+    }
+    its = (int) its_arg;
 
     // get number of processes
     int world_size;
@@ -196,8 +596,8 @@ int main(int argc, char **argv)
     MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
 
     // calculate number of lines per process
-    int lines = lines_global / world_size;
-    int rem_lines = lines_global % world_size;
+    long long lines = lines_global / world_size;
+    long long rem_lines = lines_global % world_size;
 
     /*
     In order to have an equal distribution of lines, 'rem_lines' will be distributed
@@ -206,7 +606,7 @@ int main(int argc, char **argv)
     */
 
     // gather different line line_counts for processes
-    line_counts = calloc(world_size, sizeof(int));
+    line_counts = calloc(world_size, sizeof(long long));
     if (!line_counts)
     {
       printf("Error allocating requested memory.\n");
@@ -214,7 +614,7 @@ int main(int argc, char **argv)
     }
     
     // line_displacement for gather
-    line_displ = calloc(world_size, sizeof(int));
+    line_displ = calloc(world_size, sizeof(long long));
     
     if (!line_displ)
     {
@@ -239,63 +639,131 @@ int main(int argc, char **argv)
       }             
     }
     
-    int my_lines = line_counts[my_rank];
-
-    
-    if (my_lines <= 0)
+    if (line_counts[my_rank] <= 0 || line_counts[my_rank] > INT_MAX - 2 * GHOSTZONE_SIZE)
     {
+        fprintf(stderr, "process %d: every process needs between 1 and %d lines\n",
+                my_rank, INT_MAX - 2 * GHOSTZONE_SIZE);
         MPI_Abort(MPI_COMM_WORLD, 1);
     }
 
+    int my_lines = (int) line_counts[my_rank];
+
     // create and initialize cellular automat fields
-    from = calloc(my_lines + (2 * GHOSTZONE_SIZE), sizeof(Line));
+    from = calloc((size_t) my_lines + (2 * GHOSTZONE_SIZE), sizeof(Line));
     if (!from)
     {
       printf("Error allocating requested memory.\n");
       exit(1);
     }
 
-    to   = calloc(my_lines + (2 * GHOSTZONE_SIZE), sizeof(Line));
-    if (!to)
+    if (in_place)
     {
-      printf("Error allocating requested memory.\n");
-      exit(1);
+      to = NULL;
+      columns = calloc(my_lines, sizeof(*columns));
+      if (!columns)
+      {
+        printf("Error allocating requested memory.\n");
+        exit(1);
+      }
+    }
+    else
+    {
+      to = calloc((size_t) my_lines + (2 * GHOSTZONE_SIZE), sizeof(Line));
+      if (!to)
+      {
+        printf("Error allocating requested memory.\n");
+        exit(1);
+      }
     }
 
     initConfig(from, lines, rem_lines, my_lines, my_rank);
 
+    haloInit(&halo, wire_format, my_rank, world_size);
+
+    if (snapshot_interval > 0)
+    {
+        snapshots = snapshotOpen(snapshot_prefix, my_rank, my_lines, line_displ[my_rank]);
+        if (!snapshots)
+        {
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        snapshotPut(snapshots, from, 0);
+    }
+
+    if (observables_name &&
+        observablesOpen(&observables, observables_name, my_rank,
+                        (long long) lines_global * XSIZE) != 0)
+    {
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
     //simulate transition of cellular automat
     for (i = 0;  i < its;  i++)
     {
-        simulate(from, to, my_lines, my_rank, world_size);
-        
-        temp = from;
-        from = to;
-        to = temp;
+        long long *counts = observables_name ? observablesCounts(&observables) : NULL;
+
+        perfBegin("simulate");
+        if (in_place)
+        {
+            simulate_in_place(from, rows, my_lines, &halo, counts,
+                              (i == its - 2) ? columns : NULL);
+        }
+        else
+        {
+            simulate(from, to, my_lines, &halo, counts);
+
+            temp = from;
+            from = to;
+            to = temp;
+        }
+        perfEnd("simulate", (long long) my_lines * XSIZE);
+
+        if (observables_name)
+        {
+            observablesPush(&observables, i + 1);
+        }
+
+        if (snapshots && (i + 1) % snapshot_interval == 0)
+        {
+            snapshotPut(snapshots, from, i + 1);
+        }
     }
-    
-    Line *start_buf = &from[1];
-    
-    if (my_rank == 0) // process 0 collects all the results
+
+    if (observables_name)
+    {
+        observablesClose(&observables);
+    }
+
+    if (in_place && its > 0)
     {
-      result = calloc(lines_global,  sizeof(Line));
+        restore_columns(from, my_lines, columns);
+    }
+
+    if (snapshots && snapshotClose(snapshots) != 0)
+    {
+        printf("Error writing snapshots of rank %d.\n", my_rank);
     }
     
-    MPI_Datatype mpi_line_type;
-  
-    MPI_Type_contiguous(sizeof(Line), MPI_CHAR, &mpi_line_type);    
-    MPI_Type_commit(&mpi_line_type);
-     
-    MPI_Gatherv(*start_buf, my_lines, mpi_line_type, result, line_counts, line_displ, mpi_line_type, 0, MPI_COMM_WORLD);
-   
-    if (my_rank == 0)
+    if (tree_mode)
     {
-      hash = getMD5DigestStr(result[0], sizeof(Line) * lines_global);
-      printf("%s\n", hash);
-      
-      // clean up 
-      free(result);
-      free(hash);
+      tree_verify(from, my_lines, my_rank, world_size, line_counts, digest_name);
+    }
+    else
+    {
+      // process 0 hashes the lines of all processes in rank order
+      MD5Stream *md5 = (my_rank == 0) ? md5Begin() : NULL;
+
+      gather_ordered(from[1], my_lines, sizeof(Line), my_rank, world_size,
+                     line_counts, consume_md5, md5);
+     
+      if (my_rank == 0)
+      {
+        hash = md5End(md5);
+        printf("%s\n", hash);
+        
+        // clean up 
+        free(hash);
+      }
     }
     
     // clean up   
@@ -303,8 +771,16 @@ int main(int argc, char **argv)
     free(line_displ);  
     free(from);
     free(to);
+    free(columns);
+
+    /* units are cell updates */
+    {
+        char label[32];
+
+        snprintf(label, sizeof(label), "rank %d", my_rank);
+        perfReport(stderr, label);
+    }
     
-    MPI_Type_free(&mpi_line_type);
     MPI_Finalize();
 
     return EXIT_SUCCESS;
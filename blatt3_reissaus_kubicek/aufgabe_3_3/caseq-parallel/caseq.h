@@ -0,0 +1,14 @@
+#ifndef CASEQ_H
+#define CASEQ_H
+
+/* size of ghostzone (one line for upper and lower region each) */
+#define GHOSTZONE_SIZE 1
+
+/* horizontal size of the configuration */
+#define XSIZE 1024
+
+/* "ADT" State and line of states (plus border) */
+typedef char State;
+typedef State Line[XSIZE + 2];
+
+#endif /* CASEQ_H */
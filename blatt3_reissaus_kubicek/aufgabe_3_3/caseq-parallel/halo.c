@@ -0,0 +1,171 @@
+/* compressed wire formats for the ghost zone lines
+ *
+ * packing works on 8 cells (bytes of value 0 or 1) at once: the
+ * multiplication gathers the lowest bit of every byte into the top
+ * byte, unpacking spreads the bits of a byte back with a mask.
+ */
+#include <string.h>
+
+#include "halo.h"
+
+#if XSIZE % 64 != 0 || HALO_WORDS > 64
+#error "the halo wire formats need XSIZE to be a multiple of 64, at most 4096"
+#endif
+
+int haloFormat(const char *name)
+{
+    if (strcmp(name, "raw") == 0)
+    {
+        return HALO_RAW;
+    }
+    if (strcmp(name, "packed") == 0)
+    {
+        return HALO_PACKED;
+    }
+    if (strcmp(name, "delta") == 0)
+    {
+        return HALO_DELTA;
+    }
+    return -1;
+}
+
+void haloInit(Halo *halo, HaloFormat format, int my_rank, int world_size)
+{
+    memset(halo, 0, sizeof(Halo));
+    halo->format = format;
+    halo->neighbour[HALO_TOP] = (my_rank == 0) ? world_size - 1 : my_rank - 1;
+    halo->neighbour[HALO_BOTTOM] = (my_rank + 1) % world_size;
+}
+
+static void pack(const State *line, uint64_t *packed)
+{
+    int w, b;
+
+    for (w = 0;  w < HALO_WORDS;  w++)
+    {
+        uint64_t word = 0;
+
+        for (b = 0;  b < 8;  b++)
+        {
+            uint64_t cells;
+
+            memcpy(&cells, &line[1 + 64 * w + 8 * b], sizeof(cells));
+            word |= ((cells * 0x0102040810204080ULL) >> 56) << (8 * b);
+        }
+        packed[w] = word;
+    }
+}
+
+static void unpack(const uint64_t *packed, State *line)
+{
+    int w, b;
+
+    for (w = 0;  w < HALO_WORDS;  w++)
+    {
+        for (b = 0;  b < 8;  b++)
+        {
+            uint64_t bits = ((packed[w] >> (8 * b)) & 0xFF) * 0x0101010101010101ULL;
+            uint64_t cells;
+
+            bits &= 0x8040201008040201ULL;
+            cells = ((bits + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+            memcpy(&line[1 + 64 * w + 8 * b], &cells, sizeof(cells));
+        }
+    }
+
+    /* treat torus like boundary conditions for left and right side */
+    line[0        ] = line[XSIZE];
+    line[XSIZE + 1] = line[1    ];
+}
+
+/* encode line for neighbour n, returns the size of the message */
+static int encode(Halo *halo, int n, const State *line)
+{
+    uint64_t packed[HALO_WORDS];
+    uint64_t *msg = halo->send_buf[n];
+    uint64_t mask = 0;
+    int w, count = 1;
+
+    if (halo->format == HALO_PACKED)
+    {
+        pack(line, msg);
+        return HALO_WORDS * sizeof(uint64_t);
+    }
+
+    pack(line, packed);
+    for (w = 0;  w < HALO_WORDS;  w++)
+    {
+        uint64_t diff = packed[w] ^ halo->sent[n][w];
+
+        if (diff)
+        {
+            mask |= 1ULL << w;
+            msg[count++] = diff;
+        }
+    }
+    msg[0] = mask;
+    memcpy(halo->sent[n], packed, sizeof(packed));
+
+    return count * sizeof(uint64_t);
+}
+
+static void decode(Halo *halo, int n, State *line)
+{
+    uint64_t *msg = halo->recv_buf[n];
+    int w, count = 1;
+
+    if (halo->format == HALO_PACKED)
+    {
+        unpack(msg, line);
+        return;
+    }
+
+    for (w = 0;  w < HALO_WORDS;  w++)
+    {
+        if (msg[0] & (1ULL << w))
+        {
+            halo->received[n][w] ^= msg[count++];
+        }
+    }
+    unpack(halo->received[n], line);
+}
+
+void haloStart(Halo *halo, Line *from, int my_lines)
+{
+    int top = halo->neighbour[HALO_TOP];
+    int bottom = halo->neighbour[HALO_BOTTOM];
+    int size;
+
+    if (halo->format == HALO_RAW)
+    {
+        /* receive top ghost zone */
+        MPI_Irecv(from[0], sizeof(Line), MPI_CHAR, top, 1,  MPI_COMM_WORLD, &halo->reqs[2]);
+        /* receive bottom ghost zone */
+        MPI_Irecv(from[my_lines + 1], sizeof(Line), MPI_CHAR, bottom, 0,  MPI_COMM_WORLD, &halo->reqs[3]);
+
+        /* send top line */
+        MPI_Isend(from[1], sizeof(Line), MPI_CHAR, top, 0, MPI_COMM_WORLD, &halo->reqs[0]);
+        /* send bottom line */
+        MPI_Isend(from[my_lines], sizeof(Line), MPI_CHAR, bottom, 1, MPI_COMM_WORLD, &halo->reqs[1]);
+        return;
+    }
+
+    MPI_Irecv(halo->recv_buf[HALO_TOP], HALO_MESSAGE, MPI_BYTE, top, 1, MPI_COMM_WORLD, &halo->reqs[2]);
+    MPI_Irecv(halo->recv_buf[HALO_BOTTOM], HALO_MESSAGE, MPI_BYTE, bottom, 0, MPI_COMM_WORLD, &halo->reqs[3]);
+
+    size = encode(halo, HALO_TOP, from[1]);
+    MPI_Isend(halo->send_buf[HALO_TOP], size, MPI_BYTE, top, 0, MPI_COMM_WORLD, &halo->reqs[0]);
+    size = encode(halo, HALO_BOTTOM, from[my_lines]);
+    MPI_Isend(halo->send_buf[HALO_BOTTOM], size, MPI_BYTE, bottom, 1, MPI_COMM_WORLD, &halo->reqs[1]);
+}
+
+void haloFinish(Halo *halo, Line *from, int my_lines)
+{
+    MPI_Waitall(4, halo->reqs, MPI_STATUSES_IGNORE);
+
+    if (halo->format != HALO_RAW)
+    {
+        decode(halo, HALO_TOP, from[0]);
+        decode(halo, HALO_BOTTOM, from[my_lines + 1]);
+    }
+}
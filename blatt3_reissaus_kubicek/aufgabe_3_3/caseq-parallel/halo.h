@@ -0,0 +1,51 @@
+#ifndef HALO_H
+#define HALO_H
+
+#include <stdint.h>
+#include <mpi.h>
+
+#include "caseq.h"
+
+/* wire formats of the ghost zone lines */
+typedef enum
+{
+    HALO_RAW,      /* the Line as it is, one byte per cell */
+    HALO_PACKED,   /* one bit per cell */
+    HALO_DELTA     /* changed words of the packed line against the one
+                      sent in the previous iteration */
+} HaloFormat;
+
+/* 64 bit words of a packed line */
+#define HALO_WORDS (XSIZE / 64)
+
+/* largest message: a delta mask word plus all words */
+#define HALO_MESSAGE ((HALO_WORDS + 1) * sizeof(uint64_t))
+
+/* index of the top and bottom neighbour */
+#define HALO_TOP    0
+#define HALO_BOTTOM 1
+
+typedef struct
+{
+    HaloFormat format;
+    int neighbour[2];
+    MPI_Request reqs[4];
+    /* packed lines last sent to and received from each neighbour */
+    uint64_t sent[2][HALO_WORDS];
+    uint64_t received[2][HALO_WORDS];
+    uint64_t send_buf[2][HALO_WORDS + 1];
+    uint64_t recv_buf[2][HALO_WORDS + 1];
+} Halo;
+
+/* format of its name ("raw", "packed" or "delta"), -1 if unknown */
+int haloFormat(const char *name);
+
+void haloInit(Halo *halo, HaloFormat format, int my_rank, int world_size);
+
+/* send the top and bottom line of from and receive the ghost zones */
+void haloStart(Halo *halo, Line *from, int my_lines);
+
+/* wait for the exchange and write the ghost zones to from */
+void haloFinish(Halo *halo, Line *from, int my_lines);
+
+#endif /* HALO_H */
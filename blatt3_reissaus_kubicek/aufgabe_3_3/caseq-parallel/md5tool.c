@@ -1,22 +1,23 @@
 #include "openssl/md5.h"
 
 #include <stdio.h>
-#include <string.h>
 #include <stdlib.h>
+#include <string.h>
 
-/* calc and print MD5 checksum of a memory chunk */
-char* getMD5DigestStr(void* buf, size_t buflen)
+#include "md5tool.h"
+
+struct MD5Stream
 {
   MD5_CTX ctx;
-  unsigned char sum[MD5_DIGEST_LENGTH];
+};
+
+/* hex string of a digest */
+static char* digestStr(unsigned char* sum)
+{
   int i;
   char* retval;
   char* ptr;
 
-  MD5_Init(&ctx);
-  MD5_Update(&ctx, buf, buflen);
-  MD5_Final(sum, &ctx);
-
   retval = calloc(MD5_DIGEST_LENGTH * 2 + 1, sizeof(*retval));
   ptr = retval;
 
@@ -28,4 +29,42 @@ char* getMD5DigestStr(void* buf, size_t buflen)
   return retval;
 }
 
+/* calc and print MD5 checksum of a memory chunk */
+char* getMD5DigestStr(void* buf, size_t buflen)
+{
+  MD5_CTX ctx;
+  unsigned char sum[MD5_DIGEST_LENGTH];
+
+  MD5_Init(&ctx);
+  MD5_Update(&ctx, buf, buflen);
+  MD5_Final(sum, &ctx);
+
+  return digestStr(sum);
+}
+
+MD5Stream* md5Begin(void)
+{
+  MD5Stream* stream = malloc(sizeof(*stream));
+
+  if (stream) {
+    MD5_Init(&stream->ctx);
+  }
+  return stream;
+}
+
+void md5Add(MD5Stream* stream, void* buf, size_t buflen)
+{
+  MD5_Update(&stream->ctx, buf, buflen);
+}
+
+char* md5End(MD5Stream* stream)
+{
+  unsigned char sum[MD5_DIGEST_LENGTH];
+
+  MD5_Final(sum, &stream->ctx);
+  free(stream);
+
+  return digestStr(sum);
+}
+
 
@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "observables.h"
+
+int observablesOpen(Observables *obs, const char *name, int my_rank, long long cells)
+{
+    memset(obs, 0, sizeof(Observables));
+    obs->cells = cells;
+
+    if (my_rank == 0)
+    {
+        obs->csv = fopen(name, "w");
+        if (!obs->csv)
+        {
+            printf("Error opening %s.\n", name);
+            return 1;
+        }
+        fprintf(obs->csv, "iteration,population,density,changed\n");
+    }
+
+    return 0;
+}
+
+/* wait for the pending reduction and write its result */
+static void observablesComplete(Observables *obs)
+{
+    int done = 1 - obs->current;
+    long long *global = obs->global[done];
+
+    if (!obs->pending)
+    {
+        return;
+    }
+
+    MPI_Wait(&obs->request, MPI_STATUS_IGNORE);
+    obs->pending = 0;
+
+    if (obs->csv)
+    {
+        fprintf(obs->csv, "%d,%lld,%f,%lld\n", obs->iteration[done],
+                global[OBS_POPULATION], (double) global[OBS_POPULATION] / obs->cells,
+                global[OBS_CHANGED]);
+    }
+}
+
+void observablesPush(Observables *obs, int iteration)
+{
+    int current = obs->current;
+
+    /* the previous reduction had a whole iteration to complete */
+    observablesComplete(obs);
+
+    obs->iteration[current] = iteration;
+    MPI_Iallreduce(obs->local[current], obs->global[current], OBS_COUNT,
+                   MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD, &obs->request);
+    obs->pending = 1;
+
+    /* the next iteration counts into the other buffer */
+    obs->current = 1 - current;
+    memset(obs->local[obs->current], 0, sizeof(obs->local[0]));
+}
+
+void observablesClose(Observables *obs)
+{
+    observablesComplete(obs);
+
+    if (obs->csv)
+    {
+        fclose(obs->csv);
+        obs->csv = NULL;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef OBSERVABLES_H
+#define OBSERVABLES_H
+
+#include <stdio.h>
+#include <mpi.h>
+
+/* per iteration observables of the field, counted by simulate() */
+#define OBS_POPULATION 0   /* number of nonzero cells */
+#define OBS_CHANGED    1   /* number of cells that changed their state */
+#define OBS_COUNT      2
+
+/* non-blocking reduction of the observables to a CSV file on rank 0.
+ * The reduction of iteration i is started by observablesPush and only
+ * completed by the push of iteration i + 1 (or by observablesClose), so
+ * it overlaps with the simulation of the next iteration.
+ */
+typedef struct
+{
+    FILE *csv;
+    long long cells;
+    long long local[2][OBS_COUNT];
+    long long global[2][OBS_COUNT];
+    int iteration[2];
+    int current, pending;
+    MPI_Request request;
+} Observables;
+
+/* open the CSV file name (only used on rank 0), returns 0 on success */
+int observablesOpen(Observables *obs, const char *name, int my_rank, long long cells);
+
+/* counts of the next iteration are accumulated here */
+#define observablesCounts(obs) ((obs)->local[(obs)->current])
+
+/* start the reduction of the counts of iteration */
+void observablesPush(Observables *obs, int iteration);
+
+/* complete the last reduction and close the file */
+void observablesClose(Observables *obs);
+
+#endif /* OBSERVABLES_H */
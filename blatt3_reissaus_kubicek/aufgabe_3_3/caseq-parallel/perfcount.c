@@ -0,0 +1,302 @@
+/* hardware performance counters of named regions, see perfcount.h */
+#ifdef USE_PERFCOUNT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "perfcount.h"
+
+/* events of the counter group, the first one is the group leader */
+#define PERF_CYCLES       0
+#define PERF_INSTRUCTIONS 1
+#define PERF_LLC_MISSES   2
+#define PERF_BRANCH_MISSES 3
+#define PERF_TASK_CLOCK   4   /* software event, used without a PMU */
+#define PERF_EVENTS       5
+
+#define PERF_MAX_REGIONS 16
+
+/* size of a cache line for the bytes per unit */
+#define PERF_LINE_SIZE 64
+
+static const struct
+{
+    unsigned int type;
+    unsigned long long config;
+    const char *name;
+} events[PERF_EVENTS] =
+{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,       "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,     "instructions"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,     "LLC misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES,    "branch misses"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK,       "task clock"}
+};
+
+typedef struct
+{
+    const char *name;
+    long long calls, units;
+    double seconds;
+    unsigned long long value[PERF_EVENTS];
+    /* state at perfBegin */
+    unsigned long long start[PERF_EVENTS];
+    struct timespec begin;
+} PerfRegion;
+
+typedef struct PerfThread
+{
+    int id;
+    int fd[PERF_EVENTS];      /* -1 if the event is not available */
+    int leader;
+    PerfRegion regions[PERF_MAX_REGIONS];
+    int no_regions;
+    struct PerfThread *next;
+} PerfThread;
+
+static __thread PerfThread *self = NULL;
+
+/* all threads that counted something, in order of their first region */
+static PerfThread *threads = NULL, **threads_end = &threads;
+static int no_threads = 0;
+static pthread_mutex_t threads_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int openEvent(int e, int group)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[e].type;
+    attr.config = events[e].config;
+    attr.disabled = (group == -1);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    /* this thread, any CPU */
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+/* open the counters of the calling thread: the hardware events as one
+ * group, or the task clock alone if there is no cycle counter
+ */
+static PerfThread *perfThread(void)
+{
+    PerfThread *t;
+    int e;
+
+    if (self)
+    {
+        return self;
+    }
+
+    t = calloc(1, sizeof(PerfThread));
+    if (!t)
+    {
+      printf("Error allocating requested memory.\n");
+      exit(1);
+    }
+
+    for (e = 0;  e < PERF_EVENTS;  e++)
+    {
+        t->fd[e] = -1;
+    }
+
+    t->leader = PERF_CYCLES;
+    t->fd[PERF_CYCLES] = openEvent(PERF_CYCLES, -1);
+    if (t->fd[PERF_CYCLES] >= 0)
+    {
+        for (e = PERF_INSTRUCTIONS;  e <= PERF_BRANCH_MISSES;  e++)
+        {
+            t->fd[e] = openEvent(e, t->fd[PERF_CYCLES]);
+        }
+    }
+    else
+    {
+        t->leader = PERF_TASK_CLOCK;
+        t->fd[PERF_TASK_CLOCK] = openEvent(PERF_TASK_CLOCK, -1);
+    }
+
+    if (t->fd[t->leader] >= 0)
+    {
+        ioctl(t->fd[t->leader], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(t->fd[t->leader], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    pthread_mutex_lock(&threads_lock);
+    t->id = no_threads++;
+    *threads_end = t;
+    threads_end = &t->next;
+    pthread_mutex_unlock(&threads_lock);
+
+    self = t;
+    return t;
+}
+
+/* current values of the group, in the order of the events */
+static void readCounters(PerfThread *t, unsigned long long *value)
+{
+    unsigned long long data[1 + PERF_EVENTS];
+    int e, i = 1;
+
+    memset(value, 0, PERF_EVENTS * sizeof(*value));
+    if (t->fd[t->leader] < 0 ||
+        read(t->fd[t->leader], data, sizeof(data)) < (ssize_t) sizeof(data[0]))
+    {
+        return;
+    }
+
+    /* the group holds the events that could be opened, in order */
+    for (e = 0;  e < PERF_EVENTS && i <= (int) data[0];  e++)
+    {
+        if (t->fd[e] >= 0)
+        {
+            value[e] = data[i++];
+        }
+    }
+}
+
+static PerfRegion *findRegion(PerfThread *t, const char *name)
+{
+    int r;
+
+    for (r = 0;  r < t->no_regions;  r++)
+    {
+        if (t->regions[r].name == name || strcmp(t->regions[r].name, name) == 0)
+        {
+            return &t->regions[r];
+        }
+    }
+
+    if (t->no_regions == PERF_MAX_REGIONS)
+    {
+        return NULL;
+    }
+
+    t->regions[t->no_regions].name = name;
+    return &t->regions[t->no_regions++];
+}
+
+void perfBegin(const char *region)
+{
+    PerfThread *t = perfThread();
+    PerfRegion *r = findRegion(t, region);
+
+    if (r)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &r->begin);
+        readCounters(t, r->start);
+    }
+}
+
+void perfEnd(const char *region, long long units)
+{
+    PerfThread *t = perfThread();
+    PerfRegion *r = findRegion(t, region);
+    unsigned long long value[PERF_EVENTS];
+    struct timespec end;
+    int e;
+
+    if (!r)
+    {
+        return;
+    }
+
+    readCounters(t, value);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (e = 0;  e < PERF_EVENTS;  e++)
+    {
+        r->value[e] += value[e] - r->start[e];
+    }
+    r->seconds += (end.tv_sec - r->begin.tv_sec) + (end.tv_nsec - r->begin.tv_nsec) * 1e-9;
+    r->units += units;
+    r->calls++;
+}
+
+/* value per unit, -1 if the event is not available */
+static double perUnit(const PerfThread *t, const PerfRegion *r, int e, double factor)
+{
+    if (t->fd[e] < 0 || r->units == 0)
+    {
+        return -1;
+    }
+    return factor * r->value[e] / r->units;
+}
+
+void perfReport(FILE *out, const char *label)
+{
+    PerfThread *t;
+    int r, e;
+
+    pthread_mutex_lock(&threads_lock);
+
+    for (t = threads;  t;  t = t->next)
+    {
+        for (r = 0;  r < t->no_regions;  r++)
+        {
+            PerfRegion *region = &t->regions[r];
+
+            fprintf(out, "perf: %s thread %d %s: calls %lld units %lld time %.3f s",
+                    label, t->id, region->name, region->calls, region->units, region->seconds);
+
+            if (t->fd[PERF_CYCLES] < 0)
+            {
+                fprintf(out, " task clock %.3f s (no hardware counters)\n",
+                        region->value[PERF_TASK_CLOCK] * 1e-9);
+                continue;
+            }
+
+            for (e = PERF_CYCLES;  e <= PERF_BRANCH_MISSES;  e++)
+            {
+                if (t->fd[e] >= 0)
+                {
+                    fprintf(out, " %s %llu", events[e].name, region->value[e]);
+                }
+            }
+
+            if (t->fd[PERF_INSTRUCTIONS] >= 0 && region->value[PERF_CYCLES] > 0)
+            {
+                fprintf(out, " IPC %.2f",
+                        (double) region->value[PERF_INSTRUCTIONS] / region->value[PERF_CYCLES]);
+            }
+            if (perUnit(t, region, PERF_CYCLES, 1) >= 0)
+            {
+                fprintf(out, " cycles/unit %.3f", perUnit(t, region, PERF_CYCLES, 1));
+            }
+            if (perUnit(t, region, PERF_LLC_MISSES, 1) >= 0)
+            {
+                fprintf(out, " LLC misses/unit %.5f bytes/unit %.3f",
+                        perUnit(t, region, PERF_LLC_MISSES, 1),
+                        perUnit(t, region, PERF_LLC_MISSES, PERF_LINE_SIZE));
+            }
+            if (perUnit(t, region, PERF_BRANCH_MISSES, 1) >= 0)
+            {
+                fprintf(out, " branch misses/unit %.5f", perUnit(t, region, PERF_BRANCH_MISSES, 1));
+            }
+            fprintf(out, "\n");
+        }
+
+        for (e = 0;  e < PERF_EVENTS;  e++)
+        {
+            if (t->fd[e] >= 0)
+            {
+                close(t->fd[e]);
+                t->fd[e] = -1;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&threads_lock);
+}
+
+#endif /* USE_PERFCOUNT */
@@ -0,0 +1,255 @@
+/* asynchronous, bit-packed and delta-encoded snapshot stream */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "snapshot.h"
+
+/* packed bytes and 64 bit words of one line */
+#define PACKED_LINE (XSIZE / 8)
+#define WORDS_LINE  (PACKED_LINE / sizeof(uint64_t))
+
+typedef struct
+{
+    Line *lines;
+    int iteration;
+} Slot;
+
+struct SnapshotStream
+{
+    FILE *file;
+    int lines;
+    int error;
+
+    /* ring of slots: head is the next one to write, count the used ones */
+    Slot slots[SNAPSHOT_QUEUE_SIZE];
+    int head, count, closing;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    pthread_t thread;
+    int started;
+
+    /* packed current and previous snapshot, delta buffer */
+    uint64_t *packed, *previous;
+    int64_t *delta;
+    int have_previous;
+};
+
+/* pack cells 1..XSIZE of each line, 8 cells per byte */
+static void pack(Line *buf, int lines, uint64_t *packed)
+{
+    unsigned char *out = (unsigned char *) packed;
+    int x, y, b;
+
+    for (y = 0;  y < lines;  y++)
+    {
+        const State *line = &buf[y][1];
+
+        for (x = 0;  x < PACKED_LINE;  x++)
+        {
+            unsigned char byte = 0;
+            for (b = 0;  b < 8;  b++)
+            {
+                byte |= (line[8 * x + b] != 0) << b;
+            }
+            out[y * PACKED_LINE + x] = byte;
+        }
+    }
+}
+
+static void writeRecord(SnapshotStream *s, int iteration)
+{
+    size_t words = (size_t) s->lines * WORDS_LINE;
+    size_t i, changed = 0;
+    int32_t head[2];
+    int64_t size;
+    const void *payload;
+
+    pack(s->slots[s->head].lines, s->lines, s->packed);
+
+    head[0] = iteration;
+    head[1] = SNAPSHOT_FULL;
+    size = words * sizeof(uint64_t);
+    payload = s->packed;
+
+    /* late in a run few cells change: store only the differing words,
+     * unless that is larger than the full snapshot */
+    if (s->have_previous)
+    {
+        for (i = 0;  i < words && 2 * changed < words;  i++)
+        {
+            uint64_t diff = s->packed[i] ^ s->previous[i];
+            if (diff)
+            {
+                s->delta[2 * changed    ] = i;
+                s->delta[2 * changed + 1] = diff;
+                changed++;
+            }
+        }
+
+        if (i == words)
+        {
+            head[1] = SNAPSHOT_DELTA;
+            size = changed * 2 * sizeof(int64_t);
+            payload = s->delta;
+        }
+    }
+
+    if (fwrite(head, sizeof(head), 1, s->file) != 1 ||
+        fwrite(&size, sizeof(size), 1, s->file) != 1 ||
+        (size && fwrite(payload, size, 1, s->file) != 1))
+    {
+        s->error = 1;
+    }
+
+    memcpy(s->previous, s->packed, words * sizeof(uint64_t));
+    s->have_previous = 1;
+}
+
+static void *writerRoutine(void *arg)
+{
+    SnapshotStream *s = (SnapshotStream *) arg;
+
+    pthread_mutex_lock(&s->mutex);
+    for (;;)
+    {
+        while (s->count == 0 && !s->closing)
+        {
+            pthread_cond_wait(&s->changed, &s->mutex);
+        }
+        if (s->count == 0)
+        {
+            break;
+        }
+
+        /* the slot at head is only touched by this thread until released */
+        pthread_mutex_unlock(&s->mutex);
+        writeRecord(s, s->slots[s->head].iteration);
+        pthread_mutex_lock(&s->mutex);
+
+        s->head = (s->head + 1) % SNAPSHOT_QUEUE_SIZE;
+        s->count--;
+        pthread_cond_broadcast(&s->changed);
+    }
+    pthread_mutex_unlock(&s->mutex);
+
+    return NULL;
+}
+
+SnapshotStream *snapshotOpen(const char *prefix, int rank, int lines,
+                             long long first_line)
+{
+    SnapshotStream *s;
+    char name[4096];
+    char magic[8] = "CASNAP1";
+    int32_t head[3];
+    int64_t first = first_line;
+    size_t words = (size_t) lines * WORDS_LINE;
+    int i, allocated = 1;
+
+    s = calloc(1, sizeof(SnapshotStream));
+    if (!s)
+    {
+        return NULL;
+    }
+
+    snprintf(name, sizeof(name), "%s.%d", prefix, rank);
+    s->file = fopen(name, "wb");
+    s->lines = lines;
+    s->packed   = malloc(words * sizeof(uint64_t));
+    s->previous = malloc(words * sizeof(uint64_t));
+    s->delta    = malloc(words * sizeof(int64_t));
+    for (i = 0;  i < SNAPSHOT_QUEUE_SIZE;  i++)
+    {
+        s->slots[i].lines = malloc(lines * sizeof(Line));
+        allocated = allocated && s->slots[i].lines;
+    }
+
+    head[0] = rank;
+    head[1] = lines;
+    head[2] = XSIZE;
+    if (!s->file || !s->packed || !s->previous || !s->delta || !allocated ||
+        fwrite(magic, sizeof(magic), 1, s->file) != 1 ||
+        fwrite(head, sizeof(head), 1, s->file) != 1 ||
+        fwrite(&first, sizeof(first), 1, s->file) != 1)
+    {
+        printf("Error opening snapshot file %s.\n", name);
+        s->error = 1;
+        snapshotClose(s);
+        return NULL;
+    }
+
+    pthread_mutex_init(&s->mutex, NULL);
+    pthread_cond_init(&s->changed, NULL);
+    if (pthread_create(&s->thread, NULL, writerRoutine, s) != 0)
+    {
+        printf("Error starting snapshot thread.\n");
+        pthread_mutex_destroy(&s->mutex);
+        pthread_cond_destroy(&s->changed);
+        s->error = 1;
+        snapshotClose(s);
+        return NULL;
+    }
+    s->started = 1;
+
+    return s;
+}
+
+void snapshotPut(SnapshotStream *s, Line *buf, int iteration)
+{
+    Slot *slot;
+
+    pthread_mutex_lock(&s->mutex);
+    while (s->count == SNAPSHOT_QUEUE_SIZE)
+    {
+        pthread_cond_wait(&s->changed, &s->mutex);
+    }
+    slot = &s->slots[(s->head + s->count) % SNAPSHOT_QUEUE_SIZE];
+    pthread_mutex_unlock(&s->mutex);
+
+    /* the free slot is not touched by the writer until it is counted */
+    memcpy(slot->lines, &buf[1], s->lines * sizeof(Line));
+    slot->iteration = iteration;
+
+    pthread_mutex_lock(&s->mutex);
+    s->count++;
+    pthread_cond_broadcast(&s->changed);
+    pthread_mutex_unlock(&s->mutex);
+}
+
+int snapshotClose(SnapshotStream *s)
+{
+    int i, error;
+
+    if (s->started)
+    {
+        pthread_mutex_lock(&s->mutex);
+        s->closing = 1;
+        pthread_cond_broadcast(&s->changed);
+        pthread_mutex_unlock(&s->mutex);
+
+        pthread_join(s->thread, NULL);
+        pthread_mutex_destroy(&s->mutex);
+        pthread_cond_destroy(&s->changed);
+    }
+
+    if (s->file && fclose(s->file) != 0)
+    {
+        s->error = 1;
+    }
+
+    for (i = 0;  i < SNAPSHOT_QUEUE_SIZE;  i++)
+    {
+        free(s->slots[i].lines);
+    }
+    free(s->packed);
+    free(s->previous);
+    free(s->delta);
+
+    error = s->error;
+    free(s);
+
+    return error;
+}
@@ -0,0 +1,43 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "caseq.h"
+
+/* asynchronous snapshot stream
+ *
+ * snapshotPut copies the lines of a rank into a queue slot and returns;
+ * a background thread bit-packs the slot, delta-encodes it against the
+ * previous snapshot and appends it to the rank's file <prefix>.<rank>.
+ * The caller only blocks while all slots of the queue are in use.
+ *
+ * file layout (native byte order):
+ *   header:  char magic[8] = "CASNAP1", int32 rank, int32 lines,
+ *            int32 xsize, int64 first_line (global index of line 1)
+ *   records: int32 iteration, int32 type, int64 payload size, payload
+ *     type SNAPSHOT_FULL:  lines * xsize / 8 bytes, cell x of a line
+ *                          is bit x % 8 of byte x / 8
+ *     type SNAPSHOT_DELTA: pairs of int64 word index, int64 word, the
+ *                          packed words that differ from the previous
+ *                          snapshot xor'ed with their previous value
+ */
+
+#define SNAPSHOT_FULL  0
+#define SNAPSHOT_DELTA 1
+
+/* number of snapshots that may be in flight */
+#define SNAPSHOT_QUEUE_SIZE 4
+
+typedef struct SnapshotStream SnapshotStream;
+
+/* open the stream of a rank, returns NULL on error */
+SnapshotStream *snapshotOpen(const char *prefix, int rank, int lines,
+                             long long first_line);
+
+/* queue lines 1..lines of buf as the state after iteration */
+void snapshotPut(SnapshotStream *s, Line *buf, int iteration);
+
+/* write all queued snapshots, stop the thread and close the file,
+ * returns 0 if all snapshots have been written */
+int snapshotClose(SnapshotStream *s);
+
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,141 @@
+/* multithreaded simulation with neighbour-only synchronization
+ *
+ * Thread b owns the lines first..last of both buffers. In iteration i
+ * it reads buffer (i - 1) % 2 and writes buffer i % 2. Before it
+ * calculates iteration i it sets the border columns of its own old lines
+ * and publishes ready = i. It then waits until both neighbours have
+ * published i: they have set the border columns of the lines this band
+ * reads, and they have finished iteration i - 1, the last one that read
+ * the lines this band is about to overwrite.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "bands.h"
+#include "kernel.h"
+#include "perfcount.h"
+
+/* keep the counters of different bands in different cache lines */
+#define CACHE_LINE 64
+
+typedef struct
+{
+    atomic_int ready;
+    char pad[CACHE_LINE - sizeof(atomic_int)];
+} Counter;
+
+typedef struct
+{
+    Line *buf[2];
+    int lines, its;
+    int first, last;      /* lines of the band */
+    Counter *ready, *up_ready, *down_ready;
+} Band;
+
+static void waitFor(Counter *counter, int iteration)
+{
+    while (atomic_load_explicit(&counter->ready, memory_order_acquire) < iteration)
+    {
+        sched_yield();
+    }
+}
+
+static void *bandRoutine(void *arg)
+{
+    Band *band = (Band *) arg;
+    int lines = band->lines;
+    int i, y;
+
+    perfBegin("band");
+
+    for (i = 1;  i <= band->its;  i++)
+    {
+        Line *from = band->buf[(i - 1) & 1];
+        Line *to   = band->buf[i & 1];
+
+        /* treat torus like boundary conditions for left and right side */
+        for (y = band->first;  y <= band->last;  y++)
+        {
+            from[y][0        ] = from[y][XSIZE];
+            from[y][XSIZE + 1] = from[y][1    ];
+        }
+
+        atomic_store_explicit(&band->ready->ready, i, memory_order_release);
+        waitFor(band->up_ready, i);
+        waitFor(band->down_ready, i);
+
+        for (y = band->first;  y <= band->last;  y++)
+        {
+            /* top and bottom line wrap around */
+            updateRow((y == 1) ? from[lines] : from[y - 1], from[y],
+                      (y == lines) ? from[1] : from[y + 1], to[y]);
+        }
+    }
+
+    perfEnd("band", (long long) (band->last - band->first + 1) * XSIZE * band->its);
+
+    return NULL;
+}
+
+Line *simulateBands(Line *from, Line *to, int lines, int its, int threads)
+{
+    pthread_t *tid;
+    Band *bands;
+    Counter *ready;
+    int b, first = 1;
+
+    if (threads > lines)
+    {
+        threads = lines;
+    }
+
+    tid   = malloc(threads * sizeof(pthread_t));
+    bands = malloc(threads * sizeof(Band));
+    if (!tid || !bands || posix_memalign((void **) &ready, CACHE_LINE, threads * sizeof(Counter)))
+    {
+        printf("Error allocating requested memory.\n");
+        exit(1);
+    }
+
+    for (b = 0;  b < threads;  b++)
+    {
+        Band *band = &bands[b];
+        int count = lines / threads + (b < lines % threads);
+
+        atomic_init(&ready[b].ready, 0);
+
+        band->buf[0] = from;
+        band->buf[1] = to;
+        band->lines = lines;
+        band->its = its;
+        band->first = first;
+        band->last = first + count - 1;
+        band->ready = &ready[b];
+        band->up_ready = &ready[(b + threads - 1) % threads];
+        band->down_ready = &ready[(b + 1) % threads];
+        first += count;
+    }
+
+    for (b = 0;  b < threads;  b++)
+    {
+        if (pthread_create(&tid[b], NULL, bandRoutine, &bands[b]) != 0)
+        {
+            fprintf(stderr, "failed to create pthread\n");
+            exit(1);
+        }
+    }
+
+    for (b = 0;  b < threads;  b++)
+    {
+        pthread_join(tid[b], NULL);
+    }
+
+    free(tid);
+    free(bands);
+    free(ready);
+
+    return (its & 1) ? to : from;
+}
@@ -0,0 +1,14 @@
+#ifndef BANDS_H
+#define BANDS_H
+
+#include "caseq.h"
+
+/* simulate its iterations with threads threads, each owning a band of
+ * lines. Threads only wait for the threads of the two neighbouring
+ * bands (torus), so a thread may run one iteration ahead of them.
+ * from holds the starting configuration, to is the second buffer.
+ * returns the buffer holding the result (from or to).
+ */
+Line *simulateBands(Line *from, Line *to, int lines, int its, int threads);
+
+#endif /* BANDS_H */
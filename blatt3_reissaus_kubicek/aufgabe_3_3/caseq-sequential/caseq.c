@@ -5,23 +5,49 @@
  * #1: Number of lines
  * #2: Number of iterations to be simulated
  *
+ * options:
+ * -s seed            seed of the starting configuration
+ * -r rule            rule table as 10 digits (default 0000101111),
+ *                    a comma separated list of rules in ensemble mode
+ * -e seed,seed,...   ensemble mode: simulate one configuration per seed
+ *                    at once and print one hash per seed
+ * -f file            out-of-core mode: write the starting configuration
+ *                    to file and simulate it there
+ * -F file            out-of-core mode: continue the field stored in file
+ * -d depth           iterations per pass over the file (default 8)
+ * -i                 update the field in place (one buffer instead of two)
+ * -t threads         simulate with threads threads, one band of lines each
+ *                    (double buffer only)
+ * -p stages          pipeline of stages threads, thread k calculates
+ *                    every stages-th iteration (for its >> lines)
+ * -v mode            verification: md5 (default) or tree (see treehash.h,
+ *                    same value as the tree mode of caseq-parallel)
+ * -D file            tree mode: write the digest of every line to file
+ * -k kernel          line kernel: naive (default) sums the nine cells of
+ *                    every neighbourhood, separable sums every column once
+ *                    and slides a window over the column sums
+ * -a                 auto-tune: choose the fastest of the modes above
+ *                    (see tune.h), the choice is kept in a profile per host
+ *
  */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <assert.h>
+#include <unistd.h>
 
 #include "random.h"
 #include "md5tool.h"
-
-
-/* horizontal size of the configuration */
-#define XSIZE 1024
-
-/* "ADT" State and line of states (plus border) */
-typedef char State;
-typedef State Line[XSIZE + 2];
+#include "caseq.h"
+#include "ensemble.h"
+#include "stream.h"
+#include "bands.h"
+#include "pipeline.h"
+#include "treehash.h"
+#include "tune.h"
+#include "kernel.h"
+#include "perfcount.h"
 
 /* determine random integer between 0 and n-1 */
 #define randInt(n) ((int)(nextRandomLEcuyer() * n))
@@ -30,35 +56,48 @@ void print_field(Line *buf, int lines, char* name);
 /* --------------------- CA simulation -------------------------------- */
 
 /* random starting configuration */
-static void initConfig(Line *buf, int lines)
+void initConfig(Line *buf, int lines, int seed)
+{
+    initRandomLEcuyer(seed);
+    drawLines(&buf[1], lines);
+}
+
+void drawLines(Line *buf, int lines)
 {
     int x, y;
-    initRandomLEcuyer(424243);
-    for (y = 1;  y <= lines;  y++)
+    for (y = 0;  y < lines;  y++)
     {
         for (x = 1;  x <= XSIZE;  x++)
         {
             buf[y][x] = randInt(100) >= 50;
         }
     }
-
 }
 
 /* annealing rule from ChoDro96 page 34
  * the table is used to map the number of nonzero
  * states in the neighborhood to the new state
  */
-static State anneal[10] = {0, 0, 0, 0, 1, 0, 1, 1, 1, 1};
+State anneal[RULE_SIZE] = {0, 0, 0, 0, 1, 0, 1, 1, 1, 1};
 
-/* a: pointer to array; x,y: coordinates; result: n-th element of anneal,
-      where n is the number of neighbors */
-#define transition(a, x, y) \
-    (anneal[(a)[(y)-1][(x)-1] + (a)[(y)][(x)-1] + (a)[(y)+1][(x)-1] +\
-            (a)[(y)-1][(x)  ] + (a)[(y)][(x)  ] + (a)[(y)+1][(x)  ] +\
-            (a)[(y)-1][(x)+1] + (a)[(y)][(x)+1] + (a)[(y)+1][(x)+1]])
+int parseRule(const char *str, State *rule)
+{
+    int i;
+
+    for (i = 0;  i < RULE_SIZE;  i++)
+    {
+        if (str[i] != '0' && str[i] != '1')
+        {
+            return 1;
+        }
+        rule[i] = str[i] - '0';
+    }
+
+    return (str[RULE_SIZE] == '\0' || str[RULE_SIZE] == ',') ? 0 : 1;
+}
 
 /* treat torus like boundary conditions */
-static void boundary(Line *buf, int lines)
+void boundary(Line *buf, int lines)
 {
     int x, y;
 
@@ -86,67 +125,332 @@ static void boundary(Line *buf, int lines)
  */
 static void simulate(Line *from, Line *to, int lines)
 {
-    int x, y;
+    int y;
 
     boundary(from, lines);
 
     for (y = 1;  y <= lines;  y++)
     {
-        for (x = 1;  x <= XSIZE;  x++)
+        updateRow(from[y - 1], from[y], from[y + 1], to[y]);
+    }
+}
+
+/* The result of iteration i is written to the buffer that held the
+ * configuration of iteration i - 1, so its border columns are the ones
+ * boundary() calculated one iteration earlier; they are part of the hash.
+ * The in-place update saves them in columns and restores them at the end.
+ */
+static void saveColumns(Line *buf, int lines, State (*columns)[2])
+{
+    int y;
+
+    for (y = 1;  y <= lines;  y++)
+    {
+        columns[y - 1][0] = buf[y][0        ];
+        columns[y - 1][1] = buf[y][XSIZE + 1];
+    }
+}
+
+static void restoreColumns(Line *buf, int lines, State (*columns)[2])
+{
+    int y;
+
+    for (y = 1;  y <= lines;  y++)
+    {
+        buf[y][0        ] = columns[y - 1][0];
+        buf[y][XSIZE + 1] = columns[y - 1][1];
+    }
+}
+
+/* make one simulation iteration in place.
+ * after boundary() lines 0 and lines + 1 hold copies of the old last and
+ * first line. The new line y is kept in pending until line y + 1, which
+ * still needs the old line y, has been calculated.
+ * if columns is given, the border columns are saved to it.
+ */
+static void simulateInPlace(Line *buf, int lines, Line *pending, State (*columns)[2])
+{
+    int y;
+
+    boundary(buf, lines);
+
+    if (columns)
+    {
+        saveColumns(buf, lines, columns);
+    }
+
+    for (y = 1;  y <= lines;  y++)
+    {
+        updateRow(buf[y - 1], buf[y], buf[y + 1], pending[y & 1]);
+
+        if (y > 1)
+        {
+            memcpy(&buf[y - 1][1], &pending[(y - 1) & 1][1], XSIZE * sizeof(State));
+        }
+    }
+
+    memcpy(&buf[lines][1], &pending[lines & 1][1], XSIZE * sizeof(State));
+}
+
+/* simulate its iterations with config, see TuneRun */
+static Line *simulateConfig(const TuneConfig *config, Line *from, Line *to, int lines, int its)
+{
+    Line pending[2];
+    State (*columns)[2];
+    Line *temp;
+    int i;
+
+    kernelSelect(config->kernel);
+
+    switch (config->mode)
+    {
+        case TUNE_IN_PLACE:
+            columns = calloc(lines, sizeof(*columns));
+            if (!columns)
+            {
+              printf("Error allocating requested memory.\n");
+              exit(1);
+            }
+
+            for (i = 0;  i < its;  i++)
+            {
+                simulateInPlace(from, lines, pending, (i == its - 2) ? columns : NULL);
+            }
+
+            if (its > 0)
+            {
+                restoreColumns(from, lines, columns);
+            }
+            free(columns);
+            return from;
+
+        case TUNE_BANDS:
+            return simulateBands(from, to, lines, its, config->threads);
+
+        case TUNE_PIPELINE:
+            return simulatePipeline(from, to, lines, its, config->threads);
+
+        default:
+            for (i = 0;  i < its;  i++)
+            {
+                simulate(from, to, lines);
+
+                temp = from;
+                from = to;
+                to = temp;
+            }
+            return from;
+    }
+}
+
+
+/* --------------------- verification --------------------------------- */
+
+/* print the tree hash of the field, write the line digests to digest_name */
+static void treeVerify(Line *buf, int lines, const char *digest_name)
+{
+    TreeHash tree;
+    FILE *file = NULL;
+    int y;
+
+    if (digest_name && !(file = fopen(digest_name, "w")))
+    {
+        printf("Error opening %s.\n", digest_name);
+    }
+
+    treeHashInit(&tree);
+    for (y = 1;  y <= lines;  y++)
+    {
+        uint64_t digest = lineDigest(buf[y]);
+
+        treeHashAddLine(&tree, digest);
+        if (file)
         {
-            to[y][x  ] = transition(from, x  , y);
+            fprintf(file, "%d %016llX\n", y, (unsigned long long) digest);
         }
     }
+
+    if (file)
+    {
+        fclose(file);
+    }
+    printf("tree: %016llX\n", (unsigned long long) tree.hash);
 }
 
 
 /* --------------------- measurement ---------------------------------- */
 
+static void usage(void)
+{
+    fprintf(stderr, "usage: caseq [-s seed] [-r rule[,rule...]] "
+                    "[-e seed,seed,...] [-f|-F file] [-d depth] [-i] [-t threads] [-p stages]\n"
+                    "             [-v md5|tree] [-D file] [-k naive|separable] [-a] <lines> <its>\n");
+    exit(1);
+}
+
+/* ensemble mode: parse the seed and rule lists and run all members */
+static int ensembleMain(int lines, int its, char *seed_list, char *rule_list)
+{
+    int seeds[ENSEMBLE_MAX];
+    State rules[ENSEMBLE_MAX][RULE_SIZE];
+    int members = 0, no_rules = 0, m;
+    char *tok;
+
+    for (tok = strtok(seed_list, ",");  tok;  tok = strtok(NULL, ","))
+    {
+        if (members == ENSEMBLE_MAX)
+        {
+            fprintf(stderr, "at most %d ensemble members\n", ENSEMBLE_MAX);
+            return 1;
+        }
+        seeds[members++] = atoi(tok);
+    }
+
+    while (rule_list && no_rules < ENSEMBLE_MAX &&
+           parseRule(rule_list, rules[no_rules]) == 0)
+    {
+        no_rules++;
+        rule_list = strchr(rule_list, ',');
+        rule_list = rule_list ? rule_list + 1 : NULL;
+    }
+
+    if (rule_list || (no_rules > 1 && no_rules != members))
+    {
+        fprintf(stderr, "give one rule or one rule per seed\n");
+        return 1;
+    }
+
+    /* a single (or no) rule applies to all members */
+    for (m = no_rules;  m < members;  m++)
+    {
+        memcpy(rules[m], no_rules ? rules[0] : anneal, RULE_SIZE);
+    }
+
+    return runEnsemble(lines, its, members, seeds, rules);
+}
+
 int main(int argc, char **argv)
 {
     int lines, its;
-    int i;
+    int opt;
+    int seed = DEFAULT_SEED;
+    char *rule_list = NULL, *seed_list = NULL;
+    char *stream_file = NULL;
+    int stream_create = 0, stream_depth = 8;
+    int in_place = 0, threads = 1, stages = 1, auto_tune = 0;
+    TuneConfig config;
+    int kernel = KERNEL_NAIVE;
+    int tree_mode = 0;
+    char *digest_name = NULL;
     Line *from, *to, *temp;
     char *hash;
 
-    assert(argc == 3);
+    while ((opt = getopt(argc, argv, "s:r:e:f:F:d:it:p:v:D:k:a")) != -1)
+    {
+        switch (opt)
+        {
+            case 's': seed = atoi(optarg); break;
+            case 'r': rule_list = optarg; break;
+            case 'e': seed_list = optarg; break;
+            case 'f': stream_file = optarg; stream_create = 1; break;
+            case 'F': stream_file = optarg; stream_create = 0; break;
+            case 'd': stream_depth = atoi(optarg); break;
+            case 'i': in_place = 1; break;
+            case 't': threads = atoi(optarg); break;
+            case 'p': stages = atoi(optarg); break;
+            case 'v': tree_mode = (strcmp(optarg, "tree") == 0);
+                      if (!tree_mode && strcmp(optarg, "md5") != 0) usage();
+                      break;
+            case 'D': digest_name = optarg; break;
+            case 'k': if ((kernel = kernelByName(optarg)) < 0) usage();
+                      break;
+            case 'a': auto_tune = 1; break;
+            default: usage();
+        }
+    }
+
+    if (argc - optind != 2)
+    {
+        usage();
+    }
 
-    lines = atoi(argv[1]);
-    its   = atoi(argv[2]);
+    lines = atoi(argv[optind]);
+    its   = atoi(argv[optind + 1]);
+    assert(lines > 0 && its >= 0 && threads > 0 && stages > 0);
 
-    from = (Line*) calloc((lines + 2), sizeof(Line));
-    if (!from)
+    if (seed_list)
     {
-      printf("Error allocating requested memory.\n");
-      exit(1);
+        return ensembleMain(lines, its, seed_list, rule_list);
     }
 
-    to = (Line*) calloc((lines + 2), sizeof(Line));
-    if (!to)
+    if (rule_list && (parseRule(rule_list, anneal) || strchr(rule_list, ',')))
+    {
+        usage();
+    }
+
+    kernelSelect(kernel);
+
+    if (stream_file)
+    {
+        return runStream(stream_file, stream_create, lines, its, stream_depth, seed);
+    }
+
+    from = (Line*) calloc((lines + 2), sizeof(Line));
+    if (!from)
     {
       printf("Error allocating requested memory.\n");
       exit(1);
     }
 
-    initConfig(from, lines);
+    initConfig(from, lines, seed);
 
-    for (i = 0;  i < its;  i++)
-    {
-        simulate(from, to, lines);
+    config.mode = (stages > 1) ? TUNE_PIPELINE : (threads > 1) ? TUNE_BANDS :
+                  in_place ? TUNE_IN_PLACE : TUNE_DOUBLE;
+    config.threads = (stages > 1) ? stages : threads;
+    config.kernel = kernel;
 
-        temp = from;
-        from = to;
-        to = temp;
+    if (auto_tune && its > 0)
+    {
+        tuneConfig(&config, from, lines, its, simulateConfig);
+    }
 
+    /* the in-place update needs no second buffer */
+    to = NULL;
+    if (config.mode != TUNE_IN_PLACE)
+    {
+        to = (Line*) calloc((lines + 2), sizeof(Line));
+        if (!to)
+        {
+          printf("Error allocating requested memory.\n");
+          exit(1);
+        }
+    }
 
+    perfBegin("simulate");
+    temp = simulateConfig(&config, from, to, lines, its);
+    perfEnd("simulate", (long long) lines * XSIZE * its);
+    if (temp == to)
+    {
+        to = from;
+        from = temp;
     }
+    free(to);
 
-    hash = getMD5DigestStr(from[1], sizeof(Line) * (lines));
-    printf("hash: %s\n", hash);
+    if (tree_mode)
+    {
+        treeVerify(from, lines, digest_name);
+    }
+    else
+    {
+        hash = getMD5DigestStr(from[1], sizeof(Line) * (lines));
+        printf("hash: %s\n", hash);
+        free(hash);
+    }
 
     free(from);
-    free(to);
-    free(hash);
+
+    /* units are cell updates */
+    perfReport(stderr, "caseq");
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,40 @@
+#ifndef CASEQ_H
+#define CASEQ_H
+
+/* horizontal size of the configuration */
+#define XSIZE 1024
+
+/* seed of the random starting configuration */
+#define DEFAULT_SEED 424243
+
+/* "ADT" State and line of states (plus border) */
+typedef char State;
+typedef State Line[XSIZE + 2];
+
+/* number of entries of the rule table (0..9 nonzero neighbors) */
+#define RULE_SIZE 10
+
+/* rule table used by transition, defaults to the annealing rule */
+extern State anneal[RULE_SIZE];
+
+/* a: pointer to array; x,y: coordinates; result: n-th element of anneal,
+      where n is the number of neighbors */
+#define transition(a, x, y) \
+    (anneal[(a)[(y)-1][(x)-1] + (a)[(y)][(x)-1] + (a)[(y)+1][(x)-1] +\
+            (a)[(y)-1][(x)  ] + (a)[(y)][(x)  ] + (a)[(y)+1][(x)  ] +\
+            (a)[(y)-1][(x)+1] + (a)[(y)][(x)+1] + (a)[(y)+1][(x)+1]])
+
+/* random starting configuration drawn from seed */
+void initConfig(Line *buf, int lines, int seed);
+
+/* continue the random starting configuration with buf[0..lines-1] */
+void drawLines(Line *buf, int lines);
+
+/* parse a rule given as RULE_SIZE digits (e.g. "0000101111"),
+ * returns 0 on success */
+int parseRule(const char *str, State *rule);
+
+/* treat torus like boundary conditions */
+void boundary(Line *buf, int lines);
+
+#endif /* CASEQ_H */
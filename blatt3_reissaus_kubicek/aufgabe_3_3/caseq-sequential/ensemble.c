@@ -0,0 +1,186 @@
+/* ensemble mode: simulate up to ENSEMBLE_MAX configurations at once
+ *
+ * The members are bit-sliced: cell (x, y) of all members is stored in
+ * one Word, bit m holding the state of member m. One pass of word
+ * operations therefore advances every member by one iteration.
+ * Buffers, boundary handling and the from/to swapping mirror the
+ * serial version exactly, so the per member hashes are identical to
+ * separate runs with the same seed and rule.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ensemble.h"
+#include "md5tool.h"
+
+typedef unsigned long long Word;
+typedef Word WLine[XSIZE + 2];
+
+/* full adder of three bit slices: sum and carry */
+#define ADD3_SUM(a, b, c)   ((a) ^ (b) ^ (c))
+#define ADD3_CARRY(a, b, c) (((a) & (b)) | ((c) & ((a) ^ (b))))
+
+/* treat torus like boundary conditions */
+static void boundaryWords(WLine *buf, int lines)
+{
+    int x, y;
+
+    for (y = 0;  y <= lines + 1;  y++)
+    {
+        buf[y][0        ] = buf[y][XSIZE];
+        buf[y][XSIZE + 1] = buf[y][1    ];
+    }
+
+    for (x = 0;  x <= XSIZE + 1;  x++)
+    {
+        buf[0][x        ] = buf[lines][x];
+        buf[lines + 1][x] = buf[1][x    ];
+    }
+}
+
+/* one iteration of all members.
+ * The number of nonzero neighbors (0..9) is computed as a 4 bit
+ * slice number: first the 2 bit column sums of three rows, then the
+ * sum of three adjacent column sums. rule[k] has bit m set if the rule
+ * of member m maps k neighbors to 1.
+ */
+static void simulateWords(WLine *from, WLine *to, int lines, const Word *rule)
+{
+    Word col0[XSIZE + 2], col1[XSIZE + 2];
+    int x, y, k;
+
+    boundaryWords(from, lines);
+
+    for (y = 1;  y <= lines;  y++)
+    {
+        for (x = 0;  x <= XSIZE + 1;  x++)
+        {
+            Word a = from[y - 1][x], b = from[y][x], c = from[y + 1][x];
+
+            col0[x] = ADD3_SUM(a, b, c);
+            col1[x] = ADD3_CARRY(a, b, c);
+        }
+
+        for (x = 1;  x <= XSIZE;  x++)
+        {
+            Word t0, k0, p0, p1, carry, q0, r0, r1, result;
+
+            /* weight 1 */
+            t0 = ADD3_SUM  (col0[x - 1], col0[x], col0[x + 1]);
+            k0 = ADD3_CARRY(col0[x - 1], col0[x], col0[x + 1]);
+
+            /* weight 2 (plus carry k0) */
+            p0 = ADD3_SUM  (col1[x - 1], col1[x], col1[x + 1]);
+            p1 = ADD3_CARRY(col1[x - 1], col1[x], col1[x + 1]);
+            q0 = p0 ^ k0;
+            carry = p0 & k0;
+
+            /* weight 4 and 8 */
+            r0 = p1 ^ carry;
+            r1 = p1 & carry;
+
+            result = 0;
+            for (k = 0;  k < RULE_SIZE;  k++)
+            {
+                if (rule[k])
+                {
+                    result |= rule[k] &
+                              ((k & 1) ? t0 : ~t0) & ((k & 2) ? q0 : ~q0) &
+                              ((k & 4) ? r0 : ~r0) & ((k & 8) ? r1 : ~r1);
+                }
+            }
+            to[y][x] = result;
+        }
+    }
+}
+
+int runEnsemble(int lines, int its, int members,
+                const int *seeds, State (*rules)[RULE_SIZE])
+{
+    WLine *from, *to, *temp;
+    Line *buf;
+    Word rule[RULE_SIZE];
+    struct timespec start, end;
+    double seconds;
+    char *hash;
+    int i, m, x, y;
+
+    if (members < 1 || members > ENSEMBLE_MAX)
+    {
+        fprintf(stderr, "ensemble needs 1 to %d members\n", ENSEMBLE_MAX);
+        return 1;
+    }
+
+    from = (WLine*) calloc((lines + 2), sizeof(WLine));
+    to   = (WLine*) calloc((lines + 2), sizeof(WLine));
+    buf  = (Line*)  calloc((lines + 2), sizeof(Line));
+    if (!from || !to || !buf)
+    {
+        printf("Error allocating requested memory.\n");
+        exit(1);
+    }
+
+    /* pack the members' starting configurations and rules */
+    memset(rule, 0, sizeof(rule));
+    for (m = 0;  m < members;  m++)
+    {
+        initConfig(buf, lines, seeds[m]);
+
+        for (y = 1;  y <= lines;  y++)
+        {
+            for (x = 1;  x <= XSIZE;  x++)
+            {
+                from[y][x] |= (Word) (buf[y][x] != 0) << m;
+            }
+        }
+
+        for (i = 0;  i < RULE_SIZE;  i++)
+        {
+            rule[i] |= (Word) (rules[m][i] != 0) << m;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0;  i < its;  i++)
+    {
+        simulateWords(from, to, lines, rule);
+
+        temp = from;
+        from = to;
+        to = temp;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    /* unpack every member (including the border columns) and hash it */
+    for (m = 0;  m < members;  m++)
+    {
+        for (y = 1;  y <= lines;  y++)
+        {
+            for (x = 0;  x <= XSIZE + 1;  x++)
+            {
+                buf[y][x] = (from[y][x] >> m) & 1;
+            }
+        }
+
+        hash = getMD5DigestStr(buf[1], sizeof(Line) * (lines));
+        printf("member %d seed %d hash: %s\n", m, seeds[m], hash);
+        free(hash);
+    }
+
+    if (seconds > 0)
+    {
+        fprintf(stderr, "ensemble: %d members, %.3e cell updates/s\n", members,
+                (double) members * lines * XSIZE * its / seconds);
+    }
+
+    free(from);
+    free(to);
+    free(buf);
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "caseq.h"
+
+/* maximum number of members simulated at once (one bit of a Word each) */
+#define ENSEMBLE_MAX 64
+
+/* simulate members independent configurations (one per seed, each with
+ * its own rule table) for its iterations and print one hash per member.
+ * returns 0 on success */
+int runEnsemble(int lines, int its, int members,
+                const int *seeds, State (*rules)[RULE_SIZE]);
+
+#endif /* ENSEMBLE_H */
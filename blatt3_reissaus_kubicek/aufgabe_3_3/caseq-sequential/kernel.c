@@ -0,0 +1,74 @@
+/* line kernels of the CA simulation */
+#include <string.h>
+
+#include "kernel.h"
+
+static const char *names[KERNELS] = {"naive", "separable"};
+
+static void rowNaive(const State *up, const State *mid, const State *down, State *out)
+{
+    const State *rows[3];
+    int x;
+
+    rows[0] = up;
+    rows[1] = mid;
+    rows[2] = down;
+
+    for (x = 1;  x <= XSIZE;  x++)
+    {
+        out[x] = transition(rows, x, 1);
+    }
+}
+
+/* the sum of the three cells of column x is calculated once and used
+ * for the cells x - 1, x and x + 1: the neighbourhood sum is a running
+ * sum over the column sums, the entering column is added and the
+ * leaving one subtracted. A larger radius only needs a wider window.
+ */
+static void rowSeparable(const State *up, const State *mid, const State *down, State *out)
+{
+    unsigned int column[XSIZE + 2];
+    unsigned int sum;
+    int x;
+
+    for (x = 0;  x <= XSIZE + 1;  x++)
+    {
+        column[x] = up[x] + mid[x] + down[x];
+    }
+
+    sum = column[0] + column[1];
+    for (x = 1;  x <= XSIZE;  x++)
+    {
+        sum += column[x + 1];
+        out[x] = anneal[sum];
+        sum -= column[x - 1];
+    }
+}
+
+static const RowKernel kernels[KERNELS] = {rowNaive, rowSeparable};
+
+RowKernel updateRow = rowNaive;
+
+void kernelSelect(Kernel kernel)
+{
+    updateRow = kernels[kernel];
+}
+
+int kernelByName(const char *name)
+{
+    int k;
+
+    for (k = 0;  k < KERNELS;  k++)
+    {
+        if (strcmp(name, names[k]) == 0)
+        {
+            return k;
+        }
+    }
+    return -1;
+}
+
+const char *kernelName(Kernel kernel)
+{
+    return names[kernel];
+}
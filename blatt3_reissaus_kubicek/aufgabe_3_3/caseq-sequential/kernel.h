@@ -0,0 +1,28 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include "caseq.h"
+
+/* calculate the new line out from the old lines up, mid and down
+ * (cells 1..XSIZE, the border columns of the old lines have to be set)
+ */
+typedef void (*RowKernel)(const State *up, const State *mid, const State *down, State *out);
+
+/* kernels selectable with -k */
+typedef enum
+{
+    KERNEL_NAIVE,       /* transition(): nine loads per cell */
+    KERNEL_SEPARABLE,   /* column sums and a sliding window */
+    KERNELS
+} Kernel;
+
+/* kernel used by all simulation modes, set by kernelSelect */
+extern RowKernel updateRow;
+
+void kernelSelect(Kernel kernel);
+
+/* kernel of its name ("naive" or "separable"), -1 if unknown */
+int kernelByName(const char *name);
+const char *kernelName(Kernel kernel);
+
+#endif /* KERNEL_H */
@@ -0,0 +1,43 @@
+#ifndef PERFCOUNT_H
+#define PERFCOUNT_H
+
+/* hardware performance counters of named regions (Linux perf_event_open)
+ *
+ * only compiled in with -DUSE_PERFCOUNT (make PERF=1), otherwise the
+ * calls are empty. Every thread counts its own cycles, instructions,
+ * last level cache misses and branch misses; the counters are opened in
+ * the first perfBegin of the thread. Where the hardware events are not
+ * available (no PMU, e.g. in a VM, or perf_event_paranoid too high),
+ * only the task clock and the wall time are reported.
+ *
+ *     perfBegin("simulate");
+ *     ...
+ *     perfEnd("simulate", lines * XSIZE * its);
+ *
+ * units is the amount of work of the region (cell updates, samples),
+ * perfReport prints per thread and region the totals and the derived
+ * metrics IPC, misses and bytes (misses times the cache line size) per
+ * unit. Region names have to be string literals.
+ */
+
+#ifdef USE_PERFCOUNT
+
+#include <stdio.h>
+
+void perfBegin(const char *region);
+void perfEnd(const char *region, long long units);
+
+/* print the regions of all threads, prefixed by label (e.g. the rank),
+ * and close the counters
+ */
+void perfReport(FILE *out, const char *label);
+
+#else
+
+#define perfBegin(region) ((void) 0)
+#define perfEnd(region, units) ((void) 0)
+#define perfReport(out, label) ((void) 0)
+
+#endif /* USE_PERFCOUNT */
+
+#endif /* PERFCOUNT_H */
@@ -0,0 +1,249 @@
+/* wavefront pipeline across iterations
+ *
+ * The stages are connected by single producer single consumer rings of
+ * lines; stage 0 reads the ring of the last stage, i.e. the iteration
+ * of one round earlier. That ring holds the whole field, the others only
+ * RING_LINES lines. As in the out-of-core mode (stream.c) a stage keeps
+ * a window of three input lines plus its first two input lines for the
+ * torus wrap, so iteration i emits its lines starting with line i (mod
+ * lines). The stage of the last iteration writes to the result buffer.
+ *
+ * Border columns: every stage passes on the wrap of its input lines,
+ * the stage of the last iteration the columns it received, which
+ * reproduces the hash of the double buffer version.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "pipeline.h"
+#include "kernel.h"
+#include "perfcount.h"
+
+/* lines a stage may run ahead of the next one */
+#define RING_LINES 8
+
+#define CACHE_LINE 64
+
+typedef struct
+{
+    Line line;
+    State ghost[2];   /* border columns as received */
+} Row;
+
+typedef struct
+{
+    Row *rows;
+    long size;
+    /* lines written and lines consumed, in separate cache lines */
+    _Alignas(CACHE_LINE) atomic_long written;
+    _Alignas(CACHE_LINE) atomic_long consumed;
+} Ring;
+
+typedef struct
+{
+    int k, stages, lines, its;
+    Ring *in, *out;
+    Line *result;
+    Row head[2];
+    Row window[3];
+} Stage;
+
+static Row *nextFree(Ring *ring)
+{
+    long written = atomic_load_explicit(&ring->written, memory_order_relaxed);
+
+    while (written - atomic_load_explicit(&ring->consumed, memory_order_acquire) >= ring->size)
+    {
+        sched_yield();
+    }
+    return &ring->rows[written % ring->size];
+}
+
+static void publish(Ring *ring)
+{
+    atomic_fetch_add_explicit(&ring->written, 1, memory_order_release);
+}
+
+static Row *nextFull(Ring *ring)
+{
+    long consumed = atomic_load_explicit(&ring->consumed, memory_order_relaxed);
+
+    while (atomic_load_explicit(&ring->written, memory_order_acquire) <= consumed)
+    {
+        sched_yield();
+    }
+    return &ring->rows[consumed % ring->size];
+}
+
+static void release(Ring *ring)
+{
+    atomic_fetch_add_explicit(&ring->consumed, 1, memory_order_release);
+}
+
+/* calculate the line mid of iteration and pass it on as line y */
+static void emit(Stage *stage, int iteration, long y, Row *up, Row *mid, Row *down)
+{
+    int last = (iteration == stage->its);
+    State *out;
+    Row *row = NULL;
+
+    if (last)
+    {
+        out = stage->result[y + 1];
+        out[0        ] = mid->ghost[0];
+        out[XSIZE + 1] = mid->ghost[1];
+    }
+    else
+    {
+        row = nextFree(stage->out);
+        out = row->line;
+        out[0        ] = mid->line[0];
+        out[XSIZE + 1] = mid->line[XSIZE + 1];
+    }
+
+    updateRow(up->line, mid->line, down->line, out);
+
+    if (!last)
+    {
+        publish(stage->out);
+    }
+}
+
+static void *stageRoutine(void *arg)
+{
+    Stage *stage = (Stage *) arg;
+    long lines = stage->lines;
+    long n, y;
+    int iteration;
+
+    perfBegin("stage");
+
+    for (iteration = stage->k + 1;  iteration <= stage->its;  iteration += stage->stages)
+    {
+        /* the input of iteration starts with line iteration - 1 */
+        y = (iteration - 1) % lines;
+
+        for (n = 0;  n < lines;  n++)
+        {
+            Row *row = &stage->window[n % 3];
+
+            memcpy(row, nextFull(stage->in), sizeof(Row));
+            release(stage->in);
+
+            row->ghost[0] = row->line[0];
+            row->ghost[1] = row->line[XSIZE + 1];
+
+            /* treat torus like boundary conditions for left and right side */
+            row->line[0        ] = row->line[XSIZE];
+            row->line[XSIZE + 1] = row->line[1    ];
+
+            if (n < 2)
+            {
+                stage->head[n] = *row;
+            }
+            if (n >= 2)
+            {
+                emit(stage, iteration, (y + n - 1) % lines,
+                     &stage->window[(n - 2) % 3], &stage->window[(n - 1) % 3], row);
+            }
+        }
+
+        /* torus wrap: the last and the first input line */
+        emit(stage, iteration, (y + lines - 1) % lines,
+             &stage->window[(lines - 2) % 3], &stage->window[(lines - 1) % 3], &stage->head[0]);
+        emit(stage, iteration, y,
+             &stage->window[(lines - 1) % 3], &stage->head[0], &stage->head[1]);
+    }
+
+    perfEnd("stage", lines * XSIZE * ((stage->its - stage->k + stage->stages - 1) / stage->stages));
+
+    return NULL;
+}
+
+Line *simulatePipeline(Line *from, Line *to, int lines, int its, int stages)
+{
+    pthread_t *tid;
+    Stage *stage;
+    Ring *rings;
+    int k;
+    long y;
+
+    if (stages > its)
+    {
+        stages = its;
+    }
+    if (its == 0)
+    {
+        return from;
+    }
+    if (lines < PIPELINE_MIN_LINES)
+    {
+        fprintf(stderr, "the pipeline needs at least %d lines\n", PIPELINE_MIN_LINES);
+        exit(1);
+    }
+
+    tid   = malloc(stages * sizeof(pthread_t));
+    stage = malloc(stages * sizeof(Stage));
+    if (!tid || !stage ||
+        posix_memalign((void **) &rings, CACHE_LINE, stages * sizeof(Ring)))
+    {
+        printf("Error allocating requested memory.\n");
+        exit(1);
+    }
+
+    for (k = 0;  k < stages;  k++)
+    {
+        rings[k].size = (k == stages - 1) ? lines : RING_LINES;
+        rings[k].rows = malloc(rings[k].size * sizeof(Row));
+        if (!rings[k].rows)
+        {
+            printf("Error allocating requested memory.\n");
+            exit(1);
+        }
+        atomic_init(&rings[k].written, 0);
+        atomic_init(&rings[k].consumed, 0);
+    }
+
+    /* the starting configuration is the input of stage 0 */
+    for (y = 0;  y < lines;  y++)
+    {
+        memcpy(rings[stages - 1].rows[y].line, from[y + 1], sizeof(Line));
+    }
+    atomic_store(&rings[stages - 1].written, lines);
+
+    for (k = 0;  k < stages;  k++)
+    {
+        stage[k].k = k;
+        stage[k].stages = stages;
+        stage[k].lines = lines;
+        stage[k].its = its;
+        stage[k].in = &rings[(k + stages - 1) % stages];
+        stage[k].out = &rings[k];
+        stage[k].result = to;
+
+        if (pthread_create(&tid[k], NULL, stageRoutine, &stage[k]) != 0)
+        {
+            fprintf(stderr, "failed to create pthread\n");
+            exit(1);
+        }
+    }
+
+    for (k = 0;  k < stages;  k++)
+    {
+        pthread_join(tid[k], NULL);
+    }
+
+    for (k = 0;  k < stages;  k++)
+    {
+        free(rings[k].rows);
+    }
+    free(rings);
+    free(stage);
+    free(tid);
+
+    return to;
+}
@@ -0,0 +1,17 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "caseq.h"
+
+/* lines the pipeline needs at least, the tuner only proposes it then */
+#define PIPELINE_MIN_LINES 3
+
+/* simulate its iterations in a pipeline of stages threads: thread k
+ * calculates the iterations k + 1, k + 1 + stages, ... and trails
+ * thread k - 1 by a few lines. Suited for its much larger than lines.
+ * from holds the starting configuration, to receives the result.
+ * returns the buffer holding the result (from or to).
+ */
+Line *simulatePipeline(Line *from, Line *to, int lines, int its, int stages);
+
+#endif /* PIPELINE_H */
@@ -0,0 +1,323 @@
+/* out-of-core streaming mode
+ *
+ * Stage k of a pass computes one iteration from the lines emitted by
+ * stage k - 1 (stage 0 reads the file). A stage keeps a window of the
+ * last three input lines and its first two input lines, which are
+ * needed again for the torus wrap at the end of the pass. Therefore
+ * stage k emits the lines starting with line k (mod lines) and the last
+ * stage writes line r back after line r has been read; the file can be
+ * updated in place.
+ *
+ * The border columns written to the file reproduce the ones of the
+ * in-memory version, where the result of iteration i carries the
+ * columns of iteration i - 2 (see simulate in caseq.c): every stage
+ * writes the wrap of its input, the stage of the very last iteration
+ * passes on the columns it received.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "random.h"
+#include "caseq.h"
+#include "kernel.h"
+#include "stream.h"
+#include "md5tool.h"
+
+/* lines per read and write request */
+#define IO_LINES 1024
+
+typedef struct
+{
+    Line line;
+    State ghost[2];   /* border columns as received */
+} Row;
+
+typedef struct
+{
+    int last;         /* computes the last iteration of the run */
+    long received;
+    Row head[2];
+    Row window[3];
+    Row out;
+} Stage;
+
+typedef struct
+{
+    int fd;
+    long lines;
+    int depth;
+    Stage *stages;
+
+    /* lines to write: next_line is the index of the next emitted line,
+     * buffered lines are first_line .. first_line + buffered - 1 */
+    Line *wbuf;
+    long next_line, first_line;
+    int buffered;
+    int error;
+} Stream;
+
+static int readLines(int fd, Line *buf, long first, long count)
+{
+    size_t size = count * sizeof(Line);
+    off_t offset = (off_t) first * sizeof(Line);
+    char *ptr = (char *) buf;
+
+    while (size > 0)
+    {
+        ssize_t n = pread(fd, ptr, size, offset);
+        if (n <= 0)
+        {
+            return 1;
+        }
+        ptr += n;
+        offset += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static int writeLines(int fd, Line *buf, long first, long count)
+{
+    size_t size = count * sizeof(Line);
+    off_t offset = (off_t) first * sizeof(Line);
+    const char *ptr = (const char *) buf;
+
+    while (size > 0)
+    {
+        ssize_t n = pwrite(fd, ptr, size, offset);
+        if (n <= 0)
+        {
+            return 1;
+        }
+        ptr += n;
+        offset += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static void flush(Stream *s)
+{
+    if (s->buffered > 0 && writeLines(s->fd, s->wbuf, s->first_line, s->buffered))
+    {
+        s->error = 1;
+    }
+    s->buffered = 0;
+}
+
+/* the last stage emitted a line */
+static void sink(Stream *s, const State *line)
+{
+    if (s->buffered == IO_LINES || (s->buffered > 0 && s->next_line == 0))
+    {
+        flush(s);
+    }
+    if (s->buffered == 0)
+    {
+        s->first_line = s->next_line;
+    }
+
+    memcpy(s->wbuf[s->buffered++], line, sizeof(Line));
+    s->next_line = (s->next_line + 1) % s->lines;
+}
+
+static void push(Stream *s, int k, const State *line);
+
+/* compute the line mid of stage k and pass it on */
+static void emit(Stream *s, int k, Row *up, Row *mid, Row *down)
+{
+    Stage *stage = &s->stages[k];
+
+    updateRow(up->line, mid->line, down->line, stage->out.line);
+
+    if (stage->last)
+    {
+        stage->out.line[0        ] = mid->ghost[0];
+        stage->out.line[XSIZE + 1] = mid->ghost[1];
+    }
+    else
+    {
+        stage->out.line[0        ] = mid->line[0];
+        stage->out.line[XSIZE + 1] = mid->line[XSIZE + 1];
+    }
+
+    if (k + 1 < s->depth)
+    {
+        push(s, k + 1, stage->out.line);
+    }
+    else
+    {
+        sink(s, stage->out.line);
+    }
+}
+
+/* stage k receives its next input line */
+static void push(Stream *s, int k, const State *line)
+{
+    Stage *stage = &s->stages[k];
+    long n = stage->received;
+    Row *row = &stage->window[n % 3];
+
+    memcpy(row->line, line, sizeof(Line));
+    row->ghost[0] = row->line[0];
+    row->ghost[1] = row->line[XSIZE + 1];
+
+    /* treat torus like boundary conditions for left and right side */
+    row->line[0        ] = row->line[XSIZE];
+    row->line[XSIZE + 1] = row->line[1    ];
+
+    if (n < 2)
+    {
+        stage->head[n] = *row;
+    }
+    stage->received = ++n;
+
+    if (n >= 3)
+    {
+        emit(s, k, &stage->window[(n - 3) % 3], &stage->window[(n - 2) % 3], row);
+    }
+
+    if (n == s->lines)
+    {
+        /* torus wrap: the last and the first input line */
+        emit(s, k, &stage->window[(n - 2) % 3], row, &stage->head[0]);
+        emit(s, k, row, &stage->head[0], &stage->head[1]);
+    }
+}
+
+/* advance the field by depth iterations, last if these end the run */
+static int pass(Stream *s, Line *rbuf, int depth, int last)
+{
+    long first, count, y;
+    int k;
+
+    s->depth = depth;
+    for (k = 0;  k < depth;  k++)
+    {
+        s->stages[k].received = 0;
+        s->stages[k].last = last && k == depth - 1;
+    }
+    s->next_line = depth % s->lines;
+    s->buffered = 0;
+
+    for (first = 0;  first < s->lines;  first += count)
+    {
+        count = (s->lines - first < IO_LINES) ? s->lines - first : IO_LINES;
+
+        if (readLines(s->fd, rbuf, first, count))
+        {
+            return 1;
+        }
+        for (y = 0;  y < count;  y++)
+        {
+            push(s, 0, rbuf[y]);
+        }
+    }
+    flush(s);
+
+    return s->error;
+}
+
+static int create(int fd, Line *buf, long lines, int seed)
+{
+    long first, count;
+
+    initRandomLEcuyer(seed);
+    for (first = 0;  first < lines;  first += count)
+    {
+        count = (lines - first < IO_LINES) ? lines - first : IO_LINES;
+
+        memset(buf, 0, count * sizeof(Line));
+        drawLines(buf, count);
+        if (writeLines(fd, buf, first, count))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static char *hashFile(int fd, Line *buf, long lines)
+{
+    MD5Stream *md5 = md5Begin();
+    long first, count;
+
+    for (first = 0;  first < lines;  first += count)
+    {
+        count = (lines - first < IO_LINES) ? lines - first : IO_LINES;
+
+        if (readLines(fd, buf, first, count))
+        {
+            free(md5End(md5));
+            return NULL;
+        }
+        md5Add(md5, buf, count * sizeof(Line));
+    }
+    return md5End(md5);
+}
+
+int runStream(const char *name, int create_field, int lines, int its, int depth, int seed)
+{
+    Stream s;
+    Line *rbuf;
+    char *hash;
+    int done, step;
+
+    if (lines < 3 || depth < 1)
+    {
+        fprintf(stderr, "streaming needs at least 3 lines and a depth of 1\n");
+        return 1;
+    }
+
+    memset(&s, 0, sizeof(s));
+    s.lines = lines;
+    s.fd = open(name, create_field ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644);
+    if (s.fd < 0)
+    {
+        perror(name);
+        return 1;
+    }
+    posix_fadvise(s.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    rbuf = (Line*) malloc(IO_LINES * sizeof(Line));
+    s.wbuf = (Line*) malloc(IO_LINES * sizeof(Line));
+    s.stages = (Stage*) calloc(depth, sizeof(Stage));
+    if (!rbuf || !s.wbuf || !s.stages)
+    {
+        printf("Error allocating requested memory.\n");
+        exit(1);
+    }
+
+    if (create_field && create(s.fd, rbuf, lines, seed))
+    {
+        s.error = 1;
+    }
+
+    for (done = 0;  done < its && !s.error;  done += step)
+    {
+        step = (its - done < depth) ? its - done : depth;
+        s.error = pass(&s, rbuf, step, done + step == its);
+    }
+
+    hash = s.error ? NULL : hashFile(s.fd, rbuf, lines);
+    if (hash)
+    {
+        printf("hash: %s\n", hash);
+        free(hash);
+    }
+    else
+    {
+        fprintf(stderr, "Error accessing %s.\n", name);
+        s.error = 1;
+    }
+
+    close(s.fd);
+    free(rbuf);
+    free(s.wbuf);
+    free(s.stages);
+
+    return s.error;
+}
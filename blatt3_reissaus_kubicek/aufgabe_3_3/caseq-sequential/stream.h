@@ -0,0 +1,14 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+/* out-of-core mode: the field is kept in the file name (lines Lines
+ * including the border columns, line 1 first, i.e. the memory image of
+ * lines 1..lines) and only a few lines of it are held in memory.
+ * Each pass over the file advances depth iterations in a pipeline of
+ * depth stages and writes the result back in place.
+ * if create is set, the starting configuration of seed is written first.
+ * prints the same hash as the in-memory version, returns 0 on success
+ */
+int runStream(const char *name, int create, int lines, int its, int depth, int seed);
+
+#endif /* STREAM_H */
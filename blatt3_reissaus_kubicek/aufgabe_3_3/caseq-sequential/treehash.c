@@ -0,0 +1,66 @@
+#include <string.h>
+
+#include "treehash.h"
+
+/* modulus 2^61 - 1 and base of the line polynomial */
+#define MERSENNE61 ((1ULL << 61) - 1)
+#define BASE       0x1F3D5B79A2C4E68ULL
+
+static uint64_t mulMod(uint64_t a, uint64_t b)
+{
+    unsigned __int128 product = (unsigned __int128) a * b;
+    uint64_t result = (uint64_t) (product & MERSENNE61) + (uint64_t) (product >> 61);
+
+    return (result >= MERSENNE61) ? result - MERSENNE61 : result;
+}
+
+static uint64_t addMod(uint64_t a, uint64_t b)
+{
+    uint64_t result = a + b;
+
+    return (result >= MERSENNE61) ? result - MERSENNE61 : result;
+}
+
+uint64_t lineDigest(const State *line)
+{
+    uint64_t h = 0x9E3779B97F4A7C15ULL;
+    int x;
+
+    for (x = 1;  x + 8 <= XSIZE + 1;  x += 8)
+    {
+        uint64_t word;
+
+        memcpy(&word, &line[x], sizeof(word));
+        h ^= word * 0xFF51AFD7ED558CCDULL;
+        h = ((h << 31) | (h >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+    }
+    for (;  x <= XSIZE;  x++)
+    {
+        h = (h ^ (unsigned char) line[x]) * 0x100000001B3ULL;
+    }
+
+    /* final mix, then reduce to the field of the polynomial */
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+
+    return h % MERSENNE61;
+}
+
+void treeHashInit(TreeHash *tree)
+{
+    tree->hash = 0;
+    tree->power = 1;
+}
+
+void treeHashAddLine(TreeHash *tree, uint64_t digest)
+{
+    tree->hash = addMod(mulMod(tree->hash, BASE), digest);
+    tree->power = mulMod(tree->power, BASE);
+}
+
+void treeHashCombine(TreeHash *left, const TreeHash *right)
+{
+    left->hash = addMod(mulMod(left->hash, right->power), right->hash);
+    left->power = mulMod(left->power, right->power);
+}
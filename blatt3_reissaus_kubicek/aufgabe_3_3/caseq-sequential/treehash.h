@@ -0,0 +1,35 @@
+#ifndef TREEHASH_H
+#define TREEHASH_H
+
+#include <stdint.h>
+
+#include "caseq.h"
+
+/* tree hash of a field
+ *
+ * Every line gets a 64 bit digest of its cells 1..XSIZE (the border
+ * columns are not hashed). The digests d_1..d_n are combined into
+ *   hash = d_1 * B^(n-1) + d_2 * B^(n-2) + ... + d_n   (mod 2^61 - 1)
+ * Concatenation of two parts only needs the hash and B^n of each, so
+ * parts can be combined in any tree (e.g. an MPI reduction in rank
+ * order) and the result does not depend on how the lines were split.
+ */
+typedef struct
+{
+    uint64_t hash;
+    uint64_t power;   /* B^n */
+} TreeHash;
+
+/* digest of the cells of one line */
+uint64_t lineDigest(const State *line);
+
+/* hash of no lines */
+void treeHashInit(TreeHash *tree);
+
+/* append a line with the given digest */
+void treeHashAddLine(TreeHash *tree, uint64_t digest);
+
+/* append the lines of right to left */
+void treeHashCombine(TreeHash *left, const TreeHash *right);
+
+#endif /* TREEHASH_H */
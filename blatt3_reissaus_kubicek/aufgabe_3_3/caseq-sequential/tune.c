@@ -0,0 +1,192 @@
+/* auto-tuning of the way caseq runs the simulation
+ *
+ * a profile holds one entry per calibrated problem:
+ *     <lines> <calibration its> <mode> <threads> <kernel> <seconds>
+ * later entries win, so a new calibration only has to be appended.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tune.h"
+#include "pipeline.h"
+
+/* most candidates of one calibration */
+#define TUNE_MAX_CANDIDATES 64
+
+static const char *mode_names[TUNE_MODES] = {"double", "in-place", "bands", "pipeline"};
+
+const char *tuneModeName(TuneMode mode)
+{
+    return mode_names[mode];
+}
+
+static void profileName(char *name, size_t size)
+{
+    char host[256];
+
+    if (gethostname(host, sizeof(host)) != 0)
+    {
+        strcpy(host, "unknown");
+    }
+    host[sizeof(host) - 1] = '\0';
+
+    snprintf(name, size, "caseq-%s.profile", host);
+}
+
+/* look up lines/its in the profile, returns 1 if found */
+static int profileRead(const char *name, int lines, int its, TuneConfig *config)
+{
+    FILE *file = fopen(name, "r");
+    char line[256], mode[32], kernel[32];
+    int entry_lines, entry_its, threads, m, k, found = 0;
+    double seconds;
+
+    if (!file)
+    {
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), file))
+    {
+        if (sscanf(line, "%d %d %31s %d %31s %lf", &entry_lines, &entry_its, mode,
+                   &threads, kernel, &seconds) != 6 ||
+            entry_lines != lines || entry_its != its || threads < 1 ||
+            (k = kernelByName(kernel)) < 0)
+        {
+            continue;
+        }
+
+        for (m = 0;  m < TUNE_MODES;  m++)
+        {
+            if (strcmp(mode, mode_names[m]) == 0)
+            {
+                config->mode = (TuneMode) m;
+                config->threads = threads;
+                config->kernel = (Kernel) k;
+                found = 1;
+            }
+        }
+    }
+
+    fclose(file);
+    return found;
+}
+
+static void profileWrite(const char *name, int lines, int its, const TuneConfig *config, double seconds)
+{
+    FILE *file = fopen(name, "a");
+
+    if (!file)
+    {
+        fprintf(stderr, "could not write the profile %s\n", name);
+        return;
+    }
+
+    fprintf(file, "%d %d %s %d %s %g\n", lines, its, mode_names[config->mode], config->threads,
+            kernelName(config->kernel), seconds);
+    fclose(file);
+}
+
+static void addCandidate(TuneConfig *list, int *n, TuneMode mode, int threads)
+{
+    int k;
+
+    for (k = 0;  k < KERNELS;  k++)
+    {
+        list[*n].mode = mode;
+        list[*n].threads = threads;
+        list[*n].kernel = (Kernel) k;
+        (*n)++;
+    }
+}
+
+/* candidates for this machine: the single threaded modes plus bands and
+ * pipeline with 2, 4, ... up to the number of processors, each with
+ * every kernel
+ */
+static int candidates(TuneConfig *list, int lines, int its)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int n = 0, threads;
+
+    addCandidate(list, &n, TUNE_DOUBLE, 1);
+    addCandidate(list, &n, TUNE_IN_PLACE, 1);
+
+    for (threads = 2;  threads <= cpus && n + 2 * KERNELS <= TUNE_MAX_CANDIDATES;  threads *= 2)
+    {
+        if (threads <= lines)
+        {
+            addCandidate(list, &n, TUNE_BANDS, threads);
+        }
+        if (threads <= its && lines >= PIPELINE_MIN_LINES)
+        {
+            addCandidate(list, &n, TUNE_PIPELINE, threads);
+        }
+    }
+
+    return n;
+}
+
+static void printConfig(const TuneConfig *config)
+{
+    fprintf(stderr, "tune: %s %d %s", mode_names[config->mode], config->threads,
+            kernelName(config->kernel));
+}
+
+void tuneConfig(TuneConfig *config, Line *start, int lines, int its, TuneRun run)
+{
+    TuneConfig list[TUNE_MAX_CANDIDATES];
+    struct timespec begin, end;
+    char name[300];
+    Line *from, *to;
+    double seconds, best = 0;
+    int cal_its = (its < TUNE_ITS) ? its : TUNE_ITS;
+    int n, i;
+
+    profileName(name, sizeof(name));
+    if (profileRead(name, lines, cal_its, config))
+    {
+        printConfig(config);
+        fprintf(stderr, " (from %s)\n", name);
+        return;
+    }
+
+    from = (Line*) malloc((lines + 2) * sizeof(Line));
+    to = (Line*) malloc((lines + 2) * sizeof(Line));
+    if (!from || !to)
+    {
+      printf("Error allocating requested memory.\n");
+      exit(1);
+    }
+
+    n = candidates(list, lines, cal_its);
+    for (i = 0;  i < n;  i++)
+    {
+        memcpy(from, start, (lines + 2) * sizeof(Line));
+        memcpy(to, start, (lines + 2) * sizeof(Line));
+
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        run(&list[i], from, to, lines, cal_its);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        seconds = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) * 1e-9;
+        printConfig(&list[i]);
+        fprintf(stderr, ": %g s\n", seconds);
+
+        if (i == 0 || seconds < best)
+        {
+            best = seconds;
+            *config = list[i];
+        }
+    }
+
+    free(from);
+    free(to);
+
+    printConfig(config);
+    fprintf(stderr, "\n");
+    profileWrite(name, lines, cal_its, config, best);
+}
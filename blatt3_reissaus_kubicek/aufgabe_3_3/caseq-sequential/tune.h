@@ -0,0 +1,45 @@
+#ifndef TUNE_H
+#define TUNE_H
+
+#include "caseq.h"
+#include "kernel.h"
+
+/* ways of running the simulation */
+typedef enum
+{
+    TUNE_DOUBLE,     /* two buffers, one thread */
+    TUNE_IN_PLACE,   /* one buffer, one thread */
+    TUNE_BANDS,      /* two buffers, one band of lines per thread */
+    TUNE_PIPELINE,   /* two buffers, pipeline of threads over iterations */
+    TUNE_MODES
+} TuneMode;
+
+typedef struct
+{
+    TuneMode mode;
+    int threads;     /* threads (bands) or stages (pipeline) */
+    Kernel kernel;
+} TuneConfig;
+
+/* simulate its iterations of from with config, to is the second buffer.
+ * returns the buffer holding the result (from or to).
+ */
+typedef Line *(*TuneRun)(const TuneConfig *config, Line *from, Line *to, int lines, int its);
+
+/* iterations of a calibration run */
+#define TUNE_ITS 16
+
+/* choose the fastest configuration for lines lines and its iterations.
+ * the choice is looked up in the profile file of this host
+ * (caseq-<hostname>.profile in the working directory); if it is not
+ * there, every candidate (each mode with each kernel) simulates
+ * min(its, TUNE_ITS) iterations of a copy of start with run, and the
+ * fastest is appended to the profile.
+ * remove the profile to calibrate again.
+ */
+void tuneConfig(TuneConfig *config, Line *start, int lines, int its, TuneRun run);
+
+/* name of a mode as written to the profile */
+const char *tuneModeName(TuneMode mode);
+
+#endif /* TUNE_H */
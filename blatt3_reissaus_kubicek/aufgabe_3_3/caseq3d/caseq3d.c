@@ -0,0 +1,406 @@
+/* (c) 1996,1997 Peter Sanders, Ingo Boesnach */
+/* simulate a three dimensional cellular automaton (MPI version)
+ * periodic boundaries, 26 neighbours
+ *
+ * #1 - #3: Size of the field in x, y and z
+ * #4: Number of iterations to be simulated
+ *
+ * options:
+ * -s seed            seed of the starting configuration
+ * -r rule            rule table as 28 digits, entry n is the new state
+ *                    for n nonzero cells in the 3x3x3 neighbourhood
+ *                    (default: the annealing rule, see below)
+ * -b bx,by,bz        size of the cache blocks (default 256,16,16)
+ *
+ * the processes are arranged in a periodic 3D grid (MPI_Cart_create),
+ * each one owns a block of the field. The starting configuration is
+ * drawn in the same order as in caseq (x fastest, then y, then z) and
+ * the printed MD5 hash is the one of the field in this order, so it
+ * does not depend on the number of processes or the block size.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include "random.h"
+#include "md5tool.h"
+#include "caseq3d.h"
+#include "halo3d.h"
+#include <mpi.h>
+
+/* determine random integer between 0 and n-1 */
+#define randInt(n) ((int)(nextRandomLEcuyer() * n))
+
+/* default size of the cache blocks */
+#define BLOCK_X 256
+#define BLOCK_Y 16
+#define BLOCK_Z 16
+
+#define HASH_TAG 7
+
+/* --------------------- CA simulation -------------------------------- */
+
+/* annealing rule of caseq in three dimensions: the majority of the 27
+ * cells, but 13 gives 1 and 14 gives 0
+ */
+static State anneal[RULE_SIZE] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                  0, 0, 0, 1, 0, 1, 1, 1, 1, 1,
+                                  1, 1, 1, 1, 1, 1, 1, 1};
+
+static int parse_rule(const char *str, State *rule)
+{
+    int i;
+
+    for (i = 0;  i < RULE_SIZE;  i++)
+    {
+        if (str[i] != '0' && str[i] != '1')
+        {
+            return 1;
+        }
+        rule[i] = str[i] - '0';
+    }
+
+    return (str[RULE_SIZE] == '\0') ? 0 : 1;
+}
+
+/* split n cells among parts processes, the first n % parts get one more */
+static void split(int n, int parts, int coord, int *length, int *start)
+{
+    int base = n / parts, rem = n % parts;
+
+    *length = base + (coord < rem);
+    *start = coord * base + ((coord < rem) ? coord : rem);
+}
+
+/* random starting configuration.
+ * the cells are drawn in global order, every process skips the random
+ * numbers of the cells before its first plane and keeps the ones
+ * inside its block.
+ */
+static void init_config(const Block *b, State *buf, int seed)
+{
+    long long i, skip;
+    int x, y, z;
+
+    initRandomLEcuyer(seed);
+
+    skip = (long long) b->s[DIM_Z] * b->n[DIM_Y] * b->n[DIM_X];
+    for (i = 0;  i < skip;  i++)
+    {
+        nextRandomLEcuyer();
+    }
+
+    for (z = 1;  z <= b->l[DIM_Z];  z++)
+    {
+        for (y = 0;  y < b->n[DIM_Y];  y++)
+        {
+            int in_y = (y >= b->s[DIM_Y] && y < b->s[DIM_Y] + b->l[DIM_Y]);
+
+            for (x = 0;  x < b->n[DIM_X];  x++)
+            {
+                State state = randInt(100) >= 50;
+
+                if (in_y && x >= b->s[DIM_X] && x < b->s[DIM_X] + b->l[DIM_X])
+                {
+                    buf[cell(b, x - b->s[DIM_X] + 1, y - b->s[DIM_Y] + 1, z)] = state;
+                }
+            }
+        }
+    }
+}
+
+/* make one simulation iteration, old configuration is in from,
+ * new one is written to to.
+ * the block is processed in tiles of tile[] cells. For every line of a
+ * tile the sums over the 3x3 cells in y and z are calculated once per
+ * column, the sum of three neighbouring columns is the number of
+ * nonzero cells in the neighbourhood. sums has tile[DIM_X] + 2 entries.
+ */
+static void simulate(const Block *b, State *from, State *to, const int *tile,
+                     Halo3d *halo, unsigned char *sums)
+{
+    int x, y, z, x0, y0, z0, x1, y1, z1;
+    int dy, dz;
+
+    halo3dExchange(halo, from);
+
+    for (z0 = 1;  z0 <= b->l[DIM_Z];  z0 += tile[DIM_Z])
+    {
+        z1 = (z0 + tile[DIM_Z] - 1 < b->l[DIM_Z]) ? z0 + tile[DIM_Z] - 1 : b->l[DIM_Z];
+
+        for (y0 = 1;  y0 <= b->l[DIM_Y];  y0 += tile[DIM_Y])
+        {
+            y1 = (y0 + tile[DIM_Y] - 1 < b->l[DIM_Y]) ? y0 + tile[DIM_Y] - 1 : b->l[DIM_Y];
+
+            for (x0 = 1;  x0 <= b->l[DIM_X];  x0 += tile[DIM_X])
+            {
+                x1 = (x0 + tile[DIM_X] - 1 < b->l[DIM_X]) ? x0 + tile[DIM_X] - 1 : b->l[DIM_X];
+
+                for (z = z0;  z <= z1;  z++)
+                {
+                    for (y = y0;  y <= y1;  y++)
+                    {
+                        State *out = &to[cell(b, 0, y, z)];
+
+                        memset(sums, 0, x1 - x0 + 3);
+                        for (dz = -1;  dz <= 1;  dz++)
+                        {
+                            for (dy = -1;  dy <= 1;  dy++)
+                            {
+                                const State *row = &from[cell(b, x0 - 1, y + dy, z + dz)];
+
+                                for (x = 0;  x <= x1 - x0 + 2;  x++)
+                                {
+                                    sums[x] += row[x];
+                                }
+                            }
+                        }
+
+                        for (x = x0;  x <= x1;  x++)
+                        {
+                            out[x] = anneal[sums[x - x0] + sums[x - x0 + 1] + sums[x - x0 + 2]];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/* --------------------- verification --------------------------------- */
+
+/* MD5 hash of the field in global order, returned on rank 0.
+ * rank 0 assembles one plane of the field after the other from the
+ * pieces of the processes owning it, so it never holds more than one
+ * plane.
+ */
+static char *hash_field(const Block *b, State *buf, MPI_Comm cart, const int *dims, int my_rank)
+{
+    MPI_Datatype plane;
+    int sizes[3], subsizes[3], starts[3];
+    int z, cx, cy, cz, rank, length[2], start[2], y;
+    int c[3];
+    State *global = NULL, *piece = NULL;
+    MD5Stream *md5 = NULL;
+    char *hash = NULL;
+
+    /* the interior of one plane of the block */
+    sizes[0] = b->l[DIM_Z] + 2;
+    sizes[1] = b->l[DIM_Y] + 2;
+    sizes[2] = b->l[DIM_X] + 2;
+    subsizes[0] = 1;
+    subsizes[1] = b->l[DIM_Y];
+    subsizes[2] = b->l[DIM_X];
+    starts[0] = starts[1] = starts[2] = 0;
+    MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, MPI_CHAR, &plane);
+    MPI_Type_commit(&plane);
+
+    if (my_rank != 0)
+    {
+        for (z = 1;  z <= b->l[DIM_Z];  z++)
+        {
+            MPI_Send(&buf[cell(b, 1, 1, z)], 1, plane, 0, HASH_TAG, cart);
+        }
+        MPI_Type_free(&plane);
+        return NULL;
+    }
+
+    global = malloc((size_t) b->n[DIM_X] * b->n[DIM_Y]);
+    /* the largest piece of a plane */
+    piece = malloc((size_t) (b->n[DIM_X] / dims[DIM_X] + 1) * (b->n[DIM_Y] / dims[DIM_Y] + 1));
+    if (!global || !piece)
+    {
+      printf("Error allocating requested memory.\n");
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    md5 = md5Begin();
+
+    for (cz = 0;  cz < dims[DIM_Z];  cz++)
+    {
+        int lz, sz;
+
+        split(b->n[DIM_Z], dims[DIM_Z], cz, &lz, &sz);
+
+        for (z = 1;  z <= lz;  z++)
+        {
+            for (cy = 0;  cy < dims[DIM_Y];  cy++)
+            {
+                split(b->n[DIM_Y], dims[DIM_Y], cy, &length[1], &start[1]);
+
+                for (cx = 0;  cx < dims[DIM_X];  cx++)
+                {
+                    split(b->n[DIM_X], dims[DIM_X], cx, &length[0], &start[0]);
+
+                    c[DIM_X] = cx;
+                    c[DIM_Y] = cy;
+                    c[DIM_Z] = cz;
+                    MPI_Cart_rank(cart, c, &rank);
+
+                    if (rank == 0)
+                    {
+                        for (y = 0;  y < length[1];  y++)
+                        {
+                            memcpy(&piece[(size_t) y * length[0]],
+                                   &buf[cell(b, 1, y + 1, z)], length[0]);
+                        }
+                    }
+                    else
+                    {
+                        MPI_Recv(piece, length[0] * length[1], MPI_CHAR, rank, HASH_TAG,
+                                 cart, MPI_STATUS_IGNORE);
+                    }
+
+                    for (y = 0;  y < length[1];  y++)
+                    {
+                        memcpy(&global[(size_t) (start[1] + y) * b->n[DIM_X] + start[0]],
+                               &piece[(size_t) y * length[0]], length[0]);
+                    }
+                }
+            }
+
+            md5Add(md5, global, (size_t) b->n[DIM_X] * b->n[DIM_Y]);
+        }
+    }
+
+    hash = md5End(md5);
+
+    free(global);
+    free(piece);
+    MPI_Type_free(&plane);
+
+    return hash;
+}
+
+
+/* --------------------- measurement ---------------------------------- */
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: caseq3d [-s seed] [-r rule] [-b bx,by,bz] <nx> <ny> <nz> <its>\n");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+}
+
+/* parse a count between min and max, returns 0 on success */
+static int parse_count(const char *str, long min, long max, int *value)
+{
+    char *end;
+    long result;
+
+    errno = 0;
+    result = strtol(str, &end, 10);
+    *value = (int) result;
+
+    return (errno != 0 || end == str || *end != '\0' || result < min || result > max);
+}
+
+int main(int argc, char **argv)
+{
+    int my_rank, world_size, opt, d, i, its;
+    int seed = DEFAULT_SEED;
+    int dims[3] = {0, 0, 0}, periods[3] = {1, 1, 1}, coords[3];
+    int tile[3] = {BLOCK_X, BLOCK_Y, BLOCK_Z};
+    MPI_Comm cart;
+    Block block;
+    Halo3d halo;
+    State *from, *to, *temp;
+    unsigned char *sums;
+    char *hash;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    while ((opt = getopt(argc, argv, "s:r:b:")) != -1)
+    {
+        switch (opt)
+        {
+            case 's': seed = atoi(optarg); break;
+            case 'r': if (parse_rule(optarg, anneal)) usage();
+                      break;
+            case 'b': if (sscanf(optarg, "%d,%d,%d", &tile[DIM_X], &tile[DIM_Y], &tile[DIM_Z]) != 3 ||
+                          tile[DIM_X] < 1 || tile[DIM_Y] < 1 || tile[DIM_Z] < 1) usage();
+                      break;
+            default: usage();
+        }
+    }
+
+    if (argc - optind != 4)
+    {
+        usage();
+    }
+
+    for (d = 0;  d < 3;  d++)
+    {
+        if (parse_count(argv[optind + d], 1, INT_MAX - 2, &block.n[d]))
+        {
+            usage();
+        }
+    }
+    if (parse_count(argv[optind + 3], 0, INT_MAX, &its))
+    {
+        usage();
+    }
+
+    /* periodic 3D grid of processes */
+    MPI_Dims_create(world_size, 3, dims);
+    MPI_Cart_create(MPI_COMM_WORLD, 3, dims, periods, 1, &cart);
+    MPI_Comm_rank(cart, &my_rank);
+    MPI_Cart_coords(cart, my_rank, 3, coords);
+
+    for (d = 0;  d < 3;  d++)
+    {
+        if (block.n[d] < dims[d])
+        {
+            if (my_rank == 0)
+            {
+                fprintf(stderr, "the field needs at least %d x %d x %d cells\n",
+                        dims[DIM_X], dims[DIM_Y], dims[DIM_Z]);
+            }
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        split(block.n[d], dims[d], coords[d], &block.l[d], &block.s[d]);
+    }
+
+    from = calloc(blockCells(&block), sizeof(State));
+    to = calloc(blockCells(&block), sizeof(State));
+    sums = malloc(tile[DIM_X] + 2);
+    if (!from || !to || !sums)
+    {
+      printf("Error allocating requested memory.\n");
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    init_config(&block, from, seed);
+    halo3dInit(&halo, cart, &block);
+
+    for (i = 0;  i < its;  i++)
+    {
+        simulate(&block, from, to, tile, &halo, sums);
+
+        temp = from;
+        from = to;
+        to = temp;
+    }
+
+    hash = hash_field(&block, from, cart, dims, my_rank);
+    if (my_rank == 0)
+    {
+        printf("%s\n", hash);
+        free(hash);
+    }
+
+    // clean up
+    halo3dFree(&halo);
+    free(from);
+    free(to);
+    free(sums);
+    MPI_Comm_free(&cart);
+
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+}
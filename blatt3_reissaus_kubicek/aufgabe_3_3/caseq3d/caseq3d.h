@@ -0,0 +1,38 @@
+#ifndef CASEQ3D_H
+#define CASEQ3D_H
+
+#include <stddef.h>
+
+/* seed of the random starting configuration (the one of caseq) */
+#define DEFAULT_SEED 424243
+
+/* "ADT" State */
+typedef char State;
+
+/* number of entries of the rule table (0..27 nonzero neighbors) */
+#define RULE_SIZE 28
+
+/* dimensions, x is the fastest running index */
+#define DIM_X 0
+#define DIM_Y 1
+#define DIM_Z 2
+
+/* the block of a process: l[d] cells in dimension d starting at the
+ * global index s[d], stored with a ghost layer on every side
+ */
+typedef struct
+{
+    int n[3];      /* size of the whole field */
+    int l[3];      /* size of the block */
+    int s[3];      /* global index of the first cell of the block */
+} Block;
+
+/* index of cell x, y, z (ghost layer at 0 and l + 1) in the block */
+#define cell(b, x, y, z) \
+    ((((size_t) (z) * ((b)->l[DIM_Y] + 2)) + (y)) * ((b)->l[DIM_X] + 2) + (x))
+
+/* cells of the block including the ghost layer */
+#define blockCells(b) \
+    ((size_t) ((b)->l[DIM_X] + 2) * ((b)->l[DIM_Y] + 2) * ((b)->l[DIM_Z] + 2))
+
+#endif /* CASEQ3D_H */
@@ -0,0 +1,87 @@
+#include "halo3d.h"
+
+#define SEND_LOWER 0
+#define SEND_UPPER 1
+#define RECV_LOWER 2
+#define RECV_UPPER 3
+
+void halo3dInit(Halo3d *halo, MPI_Comm cart, const Block *block)
+{
+    int sizes[3], subsizes[3], starts[3];
+    int position[4];
+    int d, e, i;
+
+    halo->cart = cart;
+
+    for (d = 0;  d < 3;  d++)
+    {
+        MPI_Cart_shift(cart, d, 1, &halo->lower[d], &halo->upper[d]);
+
+        /* position of the face in dimension d */
+        position[SEND_LOWER] = 1;
+        position[SEND_UPPER] = block->l[d];
+        position[RECV_LOWER] = 0;
+        position[RECV_UPPER] = block->l[d] + 1;
+
+        for (i = 0;  i < 4;  i++)
+        {
+            /* subarray dimensions are given slowest first (z, y, x) */
+            for (e = 0;  e < 3;  e++)
+            {
+                sizes[2 - e] = block->l[e] + 2;
+
+                if (e == d)
+                {
+                    subsizes[2 - e] = 1;
+                    starts[2 - e] = position[i];
+                }
+                else if (e < d)
+                {
+                    /* already exchanged: with the ghost layer */
+                    subsizes[2 - e] = block->l[e] + 2;
+                    starts[2 - e] = 0;
+                }
+                else
+                {
+                    subsizes[2 - e] = block->l[e];
+                    starts[2 - e] = 1;
+                }
+            }
+
+            MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C,
+                                     MPI_CHAR, &halo->face[d][i]);
+            MPI_Type_commit(&halo->face[d][i]);
+        }
+    }
+}
+
+void halo3dExchange(Halo3d *halo, State *buf)
+{
+    int d;
+
+    for (d = 0;  d < 3;  d++)
+    {
+        /* upper face to the upper neighbour, lower ghosts from the lower one */
+        MPI_Sendrecv(buf, 1, halo->face[d][SEND_UPPER], halo->upper[d], 2 * d,
+                     buf, 1, halo->face[d][RECV_LOWER], halo->lower[d], 2 * d,
+                     halo->cart, MPI_STATUS_IGNORE);
+
+        /* and the other way round */
+        MPI_Sendrecv(buf, 1, halo->face[d][SEND_LOWER], halo->lower[d], 2 * d + 1,
+                     buf, 1, halo->face[d][RECV_UPPER], halo->upper[d], 2 * d + 1,
+                     halo->cart, MPI_STATUS_IGNORE);
+    }
+}
+
+void halo3dFree(Halo3d *halo)
+{
+    int d, i;
+
+    for (d = 0;  d < 3;  d++)
+    {
+        for (i = 0;  i < 4;  i++)
+        {
+            MPI_Type_free(&halo->face[d][i]);
+        }
+    }
+}
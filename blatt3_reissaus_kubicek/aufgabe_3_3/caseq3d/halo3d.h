@@ -0,0 +1,30 @@
+#ifndef HALO3D_H
+#define HALO3D_H
+
+#include <mpi.h>
+
+#include "caseq3d.h"
+
+/* ghost layer exchange of a block in a periodic Cartesian communicator.
+ * the dimensions are exchanged one after the other, x first; the faces
+ * of y include the x ghosts and the faces of z the x and y ghosts, so
+ * three pairs of messages also fill the edges and corners, i.e. the
+ * ghosts of all 26 neighbours.
+ */
+typedef struct
+{
+    MPI_Comm cart;
+    int lower[3], upper[3];   /* neighbour ranks in every dimension */
+    /* face types: sent to lower, sent to upper,
+     * received from lower, received from upper */
+    MPI_Datatype face[3][4];
+} Halo3d;
+
+void halo3dInit(Halo3d *halo, MPI_Comm cart, const Block *block);
+
+/* fill the ghost layer of buf */
+void halo3dExchange(Halo3d *halo, State *buf);
+
+void halo3dFree(Halo3d *halo);
+
+#endif /* HALO3D_H */
@@ -0,0 +1,71 @@
+/* example for libcaseq: many short simulations with one engine
+ *
+ * #1: Number of lines
+ * #2: Number of iterations of every run
+ * #3: Number of runs (default 1), run r starts from seed 424243 + r
+ *
+ * built against libcaseq.a (cademo) and libcaseq_mpi.a (cademo_mpi),
+ * the hash of run 0 is the one printed by caseq.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "caseq.h"
+
+int main(int argc, char **argv)
+{
+    CaEngine *ca;
+    int its, runs = 1, r, my_rank = 0;
+    long long population;
+    char *hash;
+
+#ifdef CASEQ_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+#endif
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: cademo <lines> <its> [runs]\n");
+        exit(1);
+    }
+
+    its = atoi(argv[2]);
+    if (argc > 3)
+    {
+        runs = atoi(argv[3]);
+    }
+
+#ifdef CASEQ_MPI
+    ca = caCreate(atoll(argv[1]), NULL, MPI_COMM_WORLD);
+#else
+    ca = caCreate(atoll(argv[1]), NULL, CA_COMM_SELF);
+#endif
+    if (!ca)
+    {
+        fprintf(stderr, "could not create the engine\n");
+        exit(1);
+    }
+
+    for (r = 0;  r < runs;  r++)
+    {
+        caInitSeed(ca, CA_DEFAULT_SEED + r);
+        caStep(ca, its);
+
+        population = caPopulation(ca);
+        hash = caHash(ca);
+        if (my_rank == 0)
+        {
+            printf("run %d: population %lld hash %s\n", r, population, hash);
+        }
+        free(hash);
+    }
+
+    caDestroy(ca);
+
+#ifdef CASEQ_MPI
+    MPI_Finalize();
+#endif
+
+    return EXIT_SUCCESS;
+}
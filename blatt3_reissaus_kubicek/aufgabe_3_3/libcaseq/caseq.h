@@ -0,0 +1,92 @@
+/* embeddable caseq engine
+ *
+ * An engine holds one field of the cellular automaton of caseq together
+ * with everything needed to simulate it: both buffers and, in the MPI
+ * backend, a duplicated communicator and persistent halo requests. All
+ * of this is set up once by caCreate and reused by every caInit/caStep,
+ * so many short simulations cost neither process nor MPI startup.
+ *
+ * libcaseq.a is the sequential backend, libcaseq_mpi.a the MPI backend.
+ * Both have the same functions; code using the MPI backend is compiled
+ * with -DCASEQ_MPI, which makes CaComm an MPI communicator. The field is
+ * then split into blocks of lines like in caseq-parallel and all
+ * functions are collective over the communicator.
+ *
+ * With the same seed and number of steps caHash returns the hash that
+ * caseq prints (caseq-parallel uses seed CA_DEFAULT_SEED).
+ */
+#ifndef CASEQ_H
+#define CASEQ_H
+
+#ifdef CASEQ_MPI
+#include <mpi.h>
+typedef MPI_Comm CaComm;
+#else
+typedef int CaComm;
+#endif
+
+/* communicator of a single process, the only one of the sequential backend */
+#ifdef CASEQ_MPI
+#define CA_COMM_SELF MPI_COMM_SELF
+#else
+#define CA_COMM_SELF 0
+#endif
+
+/* horizontal size of the configuration */
+#define XSIZE 1024
+
+/* seed of the random starting configuration */
+#define CA_DEFAULT_SEED 424243
+
+/* "ADT" State and line of states (plus border) */
+typedef char State;
+typedef State Line[XSIZE + 2];
+
+/* number of entries of the rule table (0..9 nonzero neighbors) */
+#define RULE_SIZE 10
+
+typedef struct CaEngine CaEngine;
+
+/* engine for a field of lines lines of XSIZE cells.
+ * rule is given as RULE_SIZE digits (e.g. "0000101111"), NULL selects
+ * the annealing rule of caseq. Returns NULL if the arguments are invalid
+ * (unknown rule, fewer lines than processes) or memory is short.
+ */
+CaEngine *caCreate(long long lines, const char *rule, CaComm comm);
+
+void caDestroy(CaEngine *ca);
+
+/* random starting configuration drawn from seed.
+ * uses the global L'Ecuyer generator of random.c.
+ */
+void caInitSeed(CaEngine *ca, int seed);
+
+/* starting configuration given by the caller: cells holds the
+ * caLocalLines lines of this process, XSIZE states (0 or 1) each
+ */
+void caInitCells(CaEngine *ca, const State *cells);
+
+/* number of lines of this process and index of its first line */
+int caLocalLines(const CaEngine *ca);
+long long caFirstLine(const CaEngine *ca);
+
+/* simulate n iterations */
+void caStep(CaEngine *ca, int n);
+
+/* iterations since the last caInit */
+long long caIteration(const CaEngine *ca);
+
+/* number of nonzero cells of the whole field */
+long long caPopulation(CaEngine *ca);
+
+/* line y (local index 1..caLocalLines) of this process, including the
+ * border columns 0 and XSIZE + 1
+ */
+const State *caLine(const CaEngine *ca, int y);
+
+/* MD5 hash of the field as printed by caseq. The string is returned on
+ * rank 0 and has to be freed by the caller, the other processes get NULL.
+ */
+char *caHash(CaEngine *ca);
+
+#endif /* CASEQ_H */
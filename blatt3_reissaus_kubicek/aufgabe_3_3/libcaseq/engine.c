@@ -0,0 +1,229 @@
+/* (c) 1996,1997 Peter Sanders, Ingo Boesnach */
+/* caseq engine: the parts shared by the sequential and the MPI backend */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "random.h"
+#include "engine.h"
+
+/* determine random integer between 0 and n-1 */
+#define randInt(n) ((int)(nextRandomLEcuyer() * n))
+
+/* annealing rule from ChoDro96 page 34
+ * the table is used to map the number of nonzero
+ * states in the neighborhood to the new state
+ */
+static const State anneal[RULE_SIZE] = {0, 0, 0, 0, 1, 0, 1, 1, 1, 1};
+
+/* a: pointer to array; x,y: coordinates; result: n-th element of rule,
+      where n is the number of neighbors */
+#define transition(rule, a, x, y) \
+    ((rule)[(a)[(y)-1][(x)-1] + (a)[(y)][(x)-1] + (a)[(y)+1][(x)-1] +\
+            (a)[(y)-1][(x)  ] + (a)[(y)][(x)  ] + (a)[(y)+1][(x)  ] +\
+            (a)[(y)-1][(x)+1] + (a)[(y)][(x)+1] + (a)[(y)+1][(x)+1]])
+
+static int parseRule(const char *str, State *rule)
+{
+    int i;
+
+    for (i = 0;  i < RULE_SIZE;  i++)
+    {
+        if (str[i] != '0' && str[i] != '1')
+        {
+            return 1;
+        }
+        rule[i] = str[i] - '0';
+    }
+
+    return (str[RULE_SIZE] == '\0') ? 0 : 1;
+}
+
+CaEngine *caCreate(long long lines, const char *rule, CaComm comm)
+{
+    CaEngine *ca;
+
+    if (lines <= 0)
+    {
+        return NULL;
+    }
+
+    ca = calloc(1, sizeof(CaEngine));
+    if (!ca)
+    {
+        return NULL;
+    }
+
+    memcpy(ca->rule, anneal, RULE_SIZE);
+    if (rule && parseRule(rule, ca->rule))
+    {
+        free(ca);
+        return NULL;
+    }
+
+    ca->lines = lines;
+    if (caBackendCreate(ca, comm))
+    {
+        free(ca);
+        return NULL;
+    }
+
+    ca->buf[0] = calloc((size_t) ca->my_lines + 2, sizeof(Line));
+    ca->buf[1] = calloc((size_t) ca->my_lines + 2, sizeof(Line));
+    if (!ca->buf[0] || !ca->buf[1])
+    {
+        caDestroy(ca);
+        return NULL;
+    }
+    ca->from = ca->buf[0];
+    ca->to = ca->buf[1];
+
+    return ca;
+}
+
+void caDestroy(CaEngine *ca)
+{
+    if (!ca)
+    {
+        return;
+    }
+
+    caBackendDestroy(ca);
+    free(ca->buf[0]);
+    free(ca->buf[1]);
+    free(ca);
+}
+
+/* both buffers are cleared, so the border columns (which are part of
+ * the hash) are the same as in a fresh caseq run
+ */
+static void reset(CaEngine *ca)
+{
+    memset(ca->buf[0], 0, ((size_t) ca->my_lines + 2) * sizeof(Line));
+    memset(ca->buf[1], 0, ((size_t) ca->my_lines + 2) * sizeof(Line));
+    ca->from = ca->buf[0];
+    ca->to = ca->buf[1];
+    ca->parity = 0;
+    ca->iteration = 0;
+}
+
+void caInitSeed(CaEngine *ca, int seed)
+{
+    long long i;
+    int x, y;
+
+    reset(ca);
+    initRandomLEcuyer(seed);
+
+    /* skip the random numbers of the lines of the previous processes */
+    for (i = 0;  i < ca->first_line * XSIZE;  i++)
+    {
+        nextRandomLEcuyer();
+    }
+
+    for (y = 1;  y <= ca->my_lines;  y++)
+    {
+        for (x = 1;  x <= XSIZE;  x++)
+        {
+            ca->from[y][x] = randInt(100) >= 50;
+        }
+    }
+}
+
+void caInitCells(CaEngine *ca, const State *cells)
+{
+    int y;
+
+    reset(ca);
+    for (y = 1;  y <= ca->my_lines;  y++)
+    {
+        memcpy(&ca->from[y][1], &cells[(size_t) (y - 1) * XSIZE], XSIZE * sizeof(State));
+    }
+}
+
+int caLocalLines(const CaEngine *ca)
+{
+    return ca->my_lines;
+}
+
+long long caFirstLine(const CaEngine *ca)
+{
+    return ca->first_line;
+}
+
+long long caIteration(const CaEngine *ca)
+{
+    return ca->iteration;
+}
+
+const State *caLine(const CaEngine *ca, int y)
+{
+    return ca->from[y];
+}
+
+void caBoundaryLeftRight(Line *buf, int lines)
+{
+    int y;
+
+    for (y = 0;  y <= lines + 1;  y++)
+    {
+        /* copy rightmost column to the buffer column 0 */
+        buf[y][0      ] = buf[y][XSIZE];
+
+        /* copy leftmost column to the buffer column XSIZE + 1 */
+        buf[y][XSIZE + 1] = buf[y][1    ];
+    }
+}
+
+void caUpdate(CaEngine *ca, int first, int last)
+{
+    Line *from = ca->from, *to = ca->to;
+    const State *rule = ca->rule;
+    int x, y;
+
+    for (y = first;  y <= last;  y++)
+    {
+        for (x = 1;  x <= XSIZE;  x++)
+        {
+            to[y][x  ] = transition(rule, from, x  , y);
+        }
+    }
+}
+
+void caStep(CaEngine *ca, int n)
+{
+    Line *temp;
+    int i;
+
+    for (i = 0;  i < n;  i++)
+    {
+        caBackendStep(ca);
+
+        temp = ca->from;
+        ca->from = ca->to;
+        ca->to = temp;
+        ca->parity ^= 1;
+        ca->iteration++;
+    }
+}
+
+long long caPopulation(CaEngine *ca)
+{
+    long long population = 0;
+    int x, y;
+
+    for (y = 1;  y <= ca->my_lines;  y++)
+    {
+        for (x = 1;  x <= XSIZE;  x++)
+        {
+            population += ca->from[y][x];
+        }
+    }
+
+    return caBackendSum(ca, population);
+}
+
+char *caHash(CaEngine *ca)
+{
+    return caBackendHash(ca);
+}
@@ -0,0 +1,44 @@
+/* internals of the caseq engine shared by engine.c and the backends */
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "caseq.h"
+
+/* data of the backend (communicator, halo requests, ...) */
+typedef struct CaBackend CaBackend;
+
+struct CaEngine
+{
+    State rule[RULE_SIZE];
+    long long lines;        /* lines of the whole field */
+    long long first_line;   /* index of the first line of this process */
+    int my_lines;
+    long long iteration;
+    /* from holds the current configuration, lines 0 and my_lines + 1
+     * are the ghost zones */
+    Line *from, *to;
+    int parity;             /* which of the two buffers from is */
+    Line *buf[2];
+    CaBackend *backend;
+};
+
+/* calculate lines first..last of to from the lines of from */
+void caUpdate(CaEngine *ca, int first, int last);
+
+/* treat torus like boundary conditions for left and right side */
+void caBoundaryLeftRight(Line *buf, int lines);
+
+/* backend: split the field, set first_line and my_lines, 0 on success */
+int caBackendCreate(CaEngine *ca, CaComm comm);
+void caBackendDestroy(CaEngine *ca);
+
+/* backend: one iteration from ca->from to ca->to */
+void caBackendStep(CaEngine *ca);
+
+/* backend: sum of value over all processes */
+long long caBackendSum(CaEngine *ca, long long value);
+
+/* backend: hash of the lines of all processes in order */
+char *caBackendHash(CaEngine *ca);
+
+#endif /* ENGINE_H */
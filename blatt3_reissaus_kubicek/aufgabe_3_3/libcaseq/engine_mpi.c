@@ -0,0 +1,218 @@
+/* caseq engine: MPI backend
+ *
+ * the field is split into blocks of lines like in caseq-parallel. The
+ * ghost zones are exchanged with persistent requests, one set for each
+ * of the two buffers, that are set up in caBackendCreate and only
+ * started in every step.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "md5tool.h"
+#include "engine.h"
+
+/* tags of the lines sent to the top and the bottom neighbour */
+#define TAG_UP   0
+#define TAG_DOWN 1
+#define TAG_GATHER 2
+
+/* index of the top and bottom neighbour */
+#define TOP    0
+#define BOTTOM 1
+
+/* largest message of the hash gather */
+#define GATHER_CHUNK (1 << 24)
+
+struct CaBackend
+{
+    MPI_Comm comm;
+    int my_rank, world_size;
+    long long *line_counts;
+    int neighbour[2];
+    /* halo requests of buffer 0 and 1: receive top, receive bottom,
+     * send top, send bottom */
+    MPI_Request halo[2][4];
+};
+
+int caBackendCreate(CaEngine *ca, CaComm comm)
+{
+    CaBackend *be;
+    long long lines, rem_lines;
+    int i;
+
+    be = calloc(1, sizeof(CaBackend));
+    if (!be)
+    {
+        return 1;
+    }
+
+    for (i = 0;  i < 4;  i++)
+    {
+        be->halo[0][i] = be->halo[1][i] = MPI_REQUEST_NULL;
+    }
+
+    MPI_Comm_dup(comm, &be->comm);
+    MPI_Comm_rank(be->comm, &be->my_rank);
+    MPI_Comm_size(be->comm, &be->world_size);
+
+    be->line_counts = calloc(be->world_size, sizeof(long long));
+    if (!be->line_counts)
+    {
+        MPI_Comm_free(&be->comm);
+        free(be);
+        return 1;
+    }
+
+    /* the first rem_lines processes get one line more */
+    lines = ca->lines / be->world_size;
+    rem_lines = ca->lines % be->world_size;
+    for (i = 0;  i < be->world_size;  i++)
+    {
+        be->line_counts[i] = lines + (i < rem_lines);
+    }
+
+    ca->backend = be;
+    if (lines == 0 || lines + 1 > INT_MAX - 2)
+    {
+        caBackendDestroy(ca);
+        return 1;
+    }
+
+    ca->my_lines = (int) be->line_counts[be->my_rank];
+    ca->first_line = be->my_rank * lines + ((be->my_rank < rem_lines) ? be->my_rank : rem_lines);
+
+    be->neighbour[TOP] = (be->my_rank == 0) ? be->world_size - 1 : be->my_rank - 1;
+    be->neighbour[BOTTOM] = (be->my_rank + 1) % be->world_size;
+
+    return 0;
+}
+
+void caBackendDestroy(CaEngine *ca)
+{
+    CaBackend *be = ca->backend;
+    int i;
+
+    if (!be)
+    {
+        return;
+    }
+
+    for (i = 0;  i < 4;  i++)
+    {
+        if (be->halo[0][i] != MPI_REQUEST_NULL)
+        {
+            MPI_Request_free(&be->halo[0][i]);
+        }
+        if (be->halo[1][i] != MPI_REQUEST_NULL)
+        {
+            MPI_Request_free(&be->halo[1][i]);
+        }
+    }
+
+    MPI_Comm_free(&be->comm);
+    free(be->line_counts);
+    free(be);
+    ca->backend = NULL;
+}
+
+/* persistent requests exchanging the ghost zones of buffer buf */
+static void bind_halo(CaBackend *be, Line *buf, int my_lines, MPI_Request *reqs)
+{
+    MPI_Recv_init(buf[0], sizeof(Line), MPI_BYTE, be->neighbour[TOP],
+                  TAG_DOWN, be->comm, &reqs[0]);
+    MPI_Recv_init(buf[my_lines + 1], sizeof(Line), MPI_BYTE, be->neighbour[BOTTOM],
+                  TAG_UP, be->comm, &reqs[1]);
+    MPI_Send_init(buf[1], sizeof(Line), MPI_BYTE, be->neighbour[TOP],
+                  TAG_UP, be->comm, &reqs[2]);
+    MPI_Send_init(buf[my_lines], sizeof(Line), MPI_BYTE, be->neighbour[BOTTOM],
+                  TAG_DOWN, be->comm, &reqs[3]);
+}
+
+void caBackendStep(CaEngine *ca)
+{
+    CaBackend *be = ca->backend;
+    MPI_Request *reqs = be->halo[ca->parity];
+    int my_lines = ca->my_lines;
+
+    /* the buffers stay the same for the lifetime of the engine, so the
+     * requests are bound to them once, in the first step using them */
+    if (reqs[0] == MPI_REQUEST_NULL)
+    {
+        bind_halo(be, ca->from, my_lines, reqs);
+    }
+
+    caBoundaryLeftRight(ca->from, my_lines);
+    MPI_Startall(4, reqs);
+
+    /* calculate inner field while the ghost zones are on the way */
+    if (my_lines > 2)
+    {
+        caUpdate(ca, 2, my_lines - 1);
+    }
+
+    MPI_Waitall(4, reqs, MPI_STATUSES_IGNORE);
+
+    /* calculate outer field with help of the received ghost zones */
+    caUpdate(ca, 1, 1);
+    if (my_lines > 1)
+    {
+        caUpdate(ca, my_lines, my_lines);
+    }
+}
+
+long long caBackendSum(CaEngine *ca, long long value)
+{
+    long long sum;
+
+    MPI_Allreduce(&value, &sum, 1, MPI_LONG_LONG, MPI_SUM, ca->backend->comm);
+
+    return sum;
+}
+
+/* rank 0 hashes the lines of all processes in rank order, they are sent
+ * in messages of at most GATHER_CHUNK bytes
+ */
+char *caBackendHash(CaEngine *ca)
+{
+    CaBackend *be = ca->backend;
+    size_t bytes = (size_t) ca->my_lines * sizeof(Line);
+    size_t n;
+    char *ptr = (char *) ca->from[1];
+    char *buffer;
+    MD5Stream *md5;
+    int r;
+
+    if (be->my_rank != 0)
+    {
+        for (;  bytes > 0;  bytes -= n, ptr += n)
+        {
+            n = (bytes < GATHER_CHUNK) ? bytes : GATHER_CHUNK;
+            MPI_Send(ptr, (int) n, MPI_BYTE, 0, TAG_GATHER, be->comm);
+        }
+        return NULL;
+    }
+
+    buffer = malloc(GATHER_CHUNK);
+    if (!buffer)
+    {
+        return NULL;
+    }
+
+    md5 = md5Begin();
+    md5Add(md5, ptr, bytes);
+
+    for (r = 1;  r < be->world_size;  r++)
+    {
+        for (bytes = (size_t) be->line_counts[r] * sizeof(Line);  bytes > 0;  bytes -= n)
+        {
+            n = (bytes < GATHER_CHUNK) ? bytes : GATHER_CHUNK;
+            MPI_Recv(buffer, (int) n, MPI_BYTE, r, TAG_GATHER, be->comm, MPI_STATUS_IGNORE);
+            md5Add(md5, buffer, n);
+        }
+    }
+
+    free(buffer);
+
+    return md5End(md5);
+}
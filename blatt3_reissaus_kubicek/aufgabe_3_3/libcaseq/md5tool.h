@@ -0,0 +1,15 @@
+#ifndef MD5TOOL_H
+#define MD5TOOL_H
+
+/* calc and print MD5 checksum of a memory chunk */
+char* getMD5DigestStr(void* buf, size_t buflen);
+
+/* MD5 checksum of data given in several chunks:
+ * md5Begin, any number of md5Add, md5End returns the same string as
+ * getMD5DigestStr over the concatenated chunks and frees the stream */
+typedef struct MD5Stream MD5Stream;
+MD5Stream* md5Begin(void);
+void md5Add(MD5Stream* stream, void* buf, size_t buflen);
+char* md5End(MD5Stream* stream);
+
+#endif /* MD5TOOL_h */
@@ -0,0 +1,50 @@
+#PBS -S /bin/bash
+
+# set name of job
+#PBS -N kubicek_reissaus_ex_2
+
+# copy enviroment variables
+#PBS -V
+
+# ressources
+#PBS -l nodes=4:ppn=8
+#PBS -l walltime=02:59:00
+
+# write error and standard output in one file
+#PBS -j oe
+
+# change to working directory
+cd $PBS_O_WORKDIR
+
+#program
+make clean
+make
+
+# strong scaling: the same samples on more and more cores
+samples=4000000000
+echo ""
+echo "Strong scaling with $samples samples on 1,2,4,8,16,32 ranks."
+
+for n in 1 2 4 8 16 32
+do
+  mpirun -n $n ./pi $samples | grep scaling
+done
+
+# weak scaling: the same samples per rank
+samples=250000000
+echo ""
+echo "Weak scaling with $samples samples per rank on 1,2,4,8,16,32 ranks."
+
+for n in 1 2 4 8 16 32
+do
+  mpirun -n $n ./pi -w $samples | grep scaling
+done
+
+# one rank per node, threads within the node
+echo ""
+echo "Hybrid: 4 ranks with 1,2,4,8 threads each."
+
+for t in 1 2 4 8
+do
+  mpirun -n 4 -npernode 1 ./pi -t $t 4000000000 | grep scaling
+done
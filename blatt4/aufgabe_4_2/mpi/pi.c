@@ -0,0 +1,185 @@
+#include "random.h"
+#include "math.h"
+#include <stdlib.h>
+#include <limits.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <mpi.h>
+
+#define CIRCLE_RADIUS 1
+
+// seed of the streams, the same on all ranks
+#define SEED 4711
+
+// size of a cache line, the results of the threads are padded to it
+#define CACHE_LINE 64
+
+// every thread of every rank is one PE of the lEcuyer RNG:
+// pe = rank * threads + thread of total = ranks * threads
+typedef struct
+{
+  int pe, total;
+  long long samples_to_compute;
+  long long circle_hits_ret;
+} __attribute__ ((aligned (CACHE_LINE))) thread_arg;
+
+
+int
+circle_hit(double x, double y)
+{
+  return ((x * x) + (y * y) <= 1);
+}
+
+static void *
+thread_routine (void * arg)
+{
+  thread_arg *local_arg = (thread_arg *) arg;
+  long long samples_to_compute = local_arg->samples_to_compute;
+  long long local_circle_hits = 0;
+  RandomLEcuyer random_state;
+  long long k;
+
+  initParallelRandomLEcuyerR(&random_state, SEED, local_arg->pe, local_arg->total);
+
+  for (k = 0; k < samples_to_compute; k++)
+  {
+    double x = nextRandomLEcuyerR(&random_state) * CIRCLE_RADIUS;
+    double y = nextRandomLEcuyerR(&random_state) * CIRCLE_RADIUS;
+
+    if (circle_hit(x,y))
+    {
+      local_circle_hits ++;
+    }
+  }
+
+  local_arg->circle_hits_ret = local_circle_hits;
+
+  return NULL;
+}
+
+int
+main (int argc, char** argv)
+{
+  int provided, my_rank, world_size;
+
+  // only the main thread calls MPI
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+  if (provided < MPI_THREAD_FUNNELED)
+  {
+    fprintf (stderr, "pi: the MPI library does not support threads\n");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+  int num_threads = 1;
+  int weak = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "t:w")) != -1)
+  {
+    switch (opt)
+    {
+      case 'w':
+        weak = 1;
+        break;
+      case 't':
+        if (sscanf (optarg, "%d", &num_threads) == 1 && num_threads > 0)
+        {
+          break;
+        }
+        // fall through
+      default:
+        goto usage;
+    }
+  }
+
+  unsigned long long num_samples;
+
+  // weak scaling: num_samples * world_size must not wrap
+  if (argc - optind != 1 || sscanf (argv[optind],"%llu",&num_samples) != 1 || num_samples < 1 ||
+      (weak && num_samples > ULLONG_MAX / world_size))
+  {
+usage:
+    if (my_rank == 0)
+    {
+      printf ("Usage: mpirun -n <ranks> pi [-t threads] [-w] <number_samples>\n");
+      printf ("  -w: number_samples per rank (weak scaling), otherwise in total (strong scaling)\n");
+    }
+    MPI_Finalize();
+    return 1;
+  }
+
+  // strong scaling: the samples are split over the ranks, weak scaling:
+  // every rank computes number_samples
+  unsigned long long total_samples = weak ? num_samples * world_size : num_samples;
+  unsigned long long my_samples = total_samples / world_size + ((total_samples % world_size) > (unsigned long long) my_rank);
+
+  if (my_rank == 0)
+  {
+    printf ("start ranks: %d, threads per rank: %d, number_samples: %llu\n",
+            world_size, num_threads, total_samples);
+  }
+
+  pthread_t *tid;
+  thread_arg *thread_args;
+
+  if ((tid = (pthread_t *) malloc(sizeof(pthread_t) * num_threads)) == NULL ||
+      posix_memalign((void **) &thread_args, CACHE_LINE, sizeof(thread_arg) * num_threads) != 0)
+  {
+    printf("Error allocating requested memory.\n");
+    exit(1);
+  }
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  double start = MPI_Wtime();
+
+  int i;
+  for (i = 0; i < num_threads; i++)
+  {
+    thread_arg *current_arg = &thread_args[i];
+    current_arg->pe = my_rank * num_threads + i;
+    current_arg->total = world_size * num_threads;
+    current_arg->samples_to_compute = my_samples / num_threads + ((long long) (my_samples % num_threads) > i);
+
+    pthread_create (&tid[i], NULL, &thread_routine, (void *) current_arg);
+  }
+
+  long long my_circle_hits = 0;
+  for (i = 0; i < num_threads; i++)
+  {
+    pthread_join (tid[i], NULL);
+    my_circle_hits += thread_args[i].circle_hits_ret;
+  }
+
+  double my_time = MPI_Wtime() - start;
+
+  long long circle_hits = 0;
+  double time = 0;
+  MPI_Reduce(&my_circle_hits, &circle_hits, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&my_time, &time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+  if (my_rank == 0)
+  {
+    double pi = ((double) circle_hits / (double) total_samples) * 4;
+    printf ("estimation of pi: %f\n", pi);
+
+    double relative_error = ((pi - M_PI) / M_PI);
+    printf ("relative error: %f\n", relative_error);
+
+    printf ("time in seconds: %.2f\n", time);
+
+    // one line per run for the scaling plots: the rate per PE stays
+    // constant for perfect strong and weak scaling
+    printf ("scaling: %s ranks %d threads %d samples %llu time %.3f samples/s %.4g per PE %.4g\n",
+            weak ? "weak" : "strong", world_size, num_threads, total_samples, time,
+            total_samples / time, total_samples / time / (world_size * num_threads));
+  }
+
+  // free heap
+  free(tid);
+  free(thread_args);
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,237 @@
+#include "random.h"
+/* (c) 1996,1997 Thomas Worsch, Peter Sanders */
+/* =====================================================================
+ * The pseudo random number generator functions in this file are
+ * similar to those in 
+ *    Numerical Recipes in C, Second Edition, pages 279-282.
+ *
+ * The RNGs have names nextRandom<something> and they return a Float64.
+ *    They are initialized by a call to initRandom<something> which 
+ *    take an Int32 as seed.
+ */
+
+#define EPS 1.2e-7
+#define RNMX (1.0-EPS)
+#define IM 2147483647
+#define AM ((Float64)1.0/IM)
+#define IA 16807
+#define IQ 127773
+#define IR 2836
+
+static Int32 state = 123456789;
+
+void initRandomParkMiller(Int32 seed)
+{
+  state = seed;
+  /* but we have to make sure that state never ever is set to zero */
+  if (state==0) { state = 42; }
+}
+
+Float64 nextRandomParkMiller(void)
+{
+  Int32 k;
+  Float64 result;
+
+  k = state/IQ;
+  state = IA*(state-k*IQ)-k*IR;
+  if (state < 0) { state += IM; }
+  result = AM*state;
+  if (result >= 1.0) { result = RNMX; }
+  return result;
+}
+
+/* =====================================================================
+ * Now a pseudo RNG with a longer period (roughly 10^18) by lEcuyer
+ *    (Numerical Recipes, page 282).
+ */
+
+#define IM1 2147483563
+#define IM2 2147483399
+#define AM1 ((Float64)1.0/IM1)
+#define IMM1 (IM1-1)
+#define IA1 40014
+#define IA2 40692
+#define IQ1 53668
+#define IQ2 52774
+#define IR1 12211
+#define IR2 3791
+
+#define NTAB RANDOM_LECUYER_NTAB
+#define NDIV (1+IMM1/NTAB)
+
+/* the stream of the non-reentrant functions */
+static RandomLEcuyer global = { .state1 = 987654321 };
+
+/* ------------------------------------------------------------------ */
+static void initRandomSeedLEcuyer(RandomLEcuyer *r, Int32 seed)
+{
+  r->state1 = seed;
+  if (r->state1==0) { r->state1 = 987654321; }
+  r->state2 = r->state1;
+}
+
+/* ------------------------------------------------------------------ */
+static void initRandomTabLEcuyer(RandomLEcuyer *r)
+{
+  Int32 j, k;
+
+  for (j=NTAB+7;  j>=0;  j--) {
+    k = r->state1/IQ1;
+    r->state1 = IA1*(r->state1-k*IQ1)-k*IR1;
+    if (r->state1 < 0) { r->state1 += IM1; }
+    if (j < NTAB) { r->v[j] = r->state1; }
+  }
+  r->y = r->v[0];
+}
+
+/* ------------------------------------------------------------------ */
+void initRandomLEcuyer(Int32 seed)
+{
+  initRandomLEcuyerR(&global, seed);
+}
+
+void initRandomLEcuyerR(RandomLEcuyer *r, Int32 seed)
+{
+  initRandomSeedLEcuyer(r, seed);
+  initRandomTabLEcuyer(r);
+}
+
+/* ------------------------------------------------------------------ */
+static Int32 power(Int32 base, Card64 exp, Int32 modulus)
+{
+  Int64 temp = 1;
+  Card64 mask;
+
+  if (base < 0) { return 0; }
+
+  /* note that at on each entry into the following loop body, the 
+     actual value of temp is always positive and fits into an Int32 */
+  for (mask = ((Card64)1) << 63;  mask != 0;  mask >>= 1) {
+    temp = (temp * temp) % modulus;
+    if (exp & mask) {
+      temp = (temp * base) % modulus;
+    }
+  }
+  return ((Int32) temp);
+}
+
+/* ------------------------------------------------------------------ */
+static void forwardRandomLEcuyer(RandomLEcuyer *r, Card64 steps)
+{
+  Int32 a;
+
+  a = power(IA1, steps, IM1);
+  r->state1 = (Int32) ( (((Int64)a) * r->state1) % IM1);
+
+  a = power(IA2, steps, IM2);
+  r->state2 = (Int32) ( (((Int64)a) * r->state2) % IM2);
+}
+
+/* ------------------------------------------------------------------ */
+/*
+ * The following initialization function is intended for use on a
+ * parallel machine. 
+ * Each PE must call initParallelRandomLEcuyer once at the beginning.
+ * Calls to nextRandomLEcuyer will then return different (and hopefully 
+ *    pseudo unrelated) pseudo random numbers on different PEs.
+ * The calls to initParallelRandomLEcuyer on different PEs
+ *    *MUST* *SATISFY* *THE* *FOLLOWING* *CONDITIONS*:
+ *    - The parameter seed is the same on all PEs.
+ *    - The parameter total is the same on all PEs and it must be 
+ *      the total number of PEs using the RNG.
+ *    - The parameter pe must be different on each PE and for each
+ *      i in the set {0,1,...,total-1} there must be exactly one PE
+ *      calling initParallelRandomLEcuyer with parameter pe set to i.
+ * Please note:
+ *    - There are *NO* run time checks to see whether the above
+ *      conditions have been satisfied.
+ *    - The numbers generated on different PEs are probably only more or 
+ *      less unrelated as long as the number of calls of nextRandomLEcuyer
+ *      on each of the PEs is smaller than the period of the RNG
+ *      (approx. 10^18) divided by the number of PEs (probably below 10^4).
+ *      Since 10^14 calls of nextRandomLEcuyer will take quite some time, 
+ *      you are probably safe using this RNG.
+ *    - This function uses nextRandomParkMiller. If you want to have 
+ *      reproducible results, make sure that you do not use
+ *      RandomParkMiller yourself before calling initParallelRandomLEcuyer.
+ */
+static void initParallelShiftedLEcuyer(RandomLEcuyer *r, Int32 seed, Int32 pe, Int32 total,
+                                       Float64 shift)
+{
+  Card64 steps;
+
+  initRandomSeedLEcuyer(r, seed);
+
+  /* The period of the RNG is roughly 2.3e18, i.e. 2^61,
+     which should be distributed onto the PEs approximately equally;
+     because we do not know the exact value we are careful and take
+     one half of the average length of the interval per PE: */
+  steps = (((Card64)1) << 60)/total;
+
+  /* For PE number pe we get the starting point: */
+  steps = steps * pe;
+
+  /* Finally the starting point for each PE is randomly shifted
+     by an amount which is small compared to the length of
+     its interval (as long as there are much less than 2^30 PEs :-).
+     Therefore steps will still be far below the end of its interval: */
+  steps = steps + (Card64) (shift * (((Card64)1) << 30));
+     
+  /* Now the RNG is initialized for PE pe as if it had already made steps 
+     many steps from the initial seed. */
+  forwardRandomLEcuyer(r, steps);
+
+  initRandomTabLEcuyer(r);
+}
+
+void initParallelRandomLEcuyer(Int32 seed, Int32 pe, Int32 total)
+{
+  initParallelShiftedLEcuyer(&global, seed, pe, total, nextRandomParkMiller());
+}
+
+/* the shift is the first number of the Park-Miller RNG as it is at the
+   start of the program, without touching its state */
+void initParallelRandomLEcuyerR(RandomLEcuyer *r, Int32 seed, Int32 pe, Int32 total)
+{
+  Int32 pm = 123456789, k;
+  Float64 shift;
+
+  k = pm/IQ;
+  pm = IA*(pm-k*IQ)-k*IR;
+  if (pm < 0) { pm += IM; }
+  shift = AM*pm;
+  if (shift >= 1.0) { shift = RNMX; }
+
+  initParallelShiftedLEcuyer(r, seed, pe, total, shift);
+}
+
+/* ------------------------------------------------------------------ */
+Float64 nextRandomLEcuyer(void)
+{
+  return nextRandomLEcuyerR(&global);
+}
+
+Float64 nextRandomLEcuyerR(RandomLEcuyer *r)
+{
+  Int32 k;
+  Float64 result;
+  int j;
+
+  k = r->state1/IQ1;
+  r->state1 = IA1*(r->state1-k*IQ1)-k*IR1;
+  if (r->state1 < 0) { r->state1 += IM1; }
+
+  k = r->state2/IQ2;
+  r->state2 = IA2*(r->state2-k*IQ2)-k*IR2;
+  if (r->state2 < 0) { r->state2 += IM2; }
+
+  j = r->y/NDIV;
+  r->y = r->v[j] - r->state2;
+  r->v[j] = r->state1;
+
+  if (r->y < 1) { r->y += IMM1; }
+
+  result = AM1*r->y;
+  if (result >= 1.0) { result = RNMX; }
+  return result;
+}
@@ -1,13 +1,25 @@
 #include "random.h"
+#include "simd.h"
 #include "math.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include <omp.h>
 #include <time.h>
 
 #define CIRCLE_RADIUS 1
 
-static int circle_hits = 0;
+// samples per iteration of the SIMD loop
+#define SIMD_BLOCK 4096
+
+static long long circle_hits = 0;
+
+// kernel of the loop: scalar (0) or simd_circle_hits on blocks (1)
+static int use_simd = 0;
+
+// generator: pr_random (0) or the long period pr_pcg_r (1)
+static int use_pcg = 1;
 
 void 
 get_difference(struct timespec *start, struct timespec *end, struct timespec *diff){
@@ -42,38 +54,120 @@ main (int argc, char** argv)
     exit(1);
   }
   
-  if (argc != 3)
+  int opt;
+  while ((opt = getopt(argc, argv, "k:g:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'g':
+        use_pcg = (strcmp(optarg, "pcg") == 0);
+        if (use_pcg || strcmp(optarg, "lcg") == 0)
+        {
+          break;
+        }
+        goto usage;
+      case 'k':
+        use_simd = (strcmp(optarg, "simd") == 0);
+        if (use_simd || strcmp(optarg, "scalar") == 0)
+        {
+          break;
+        }
+        // fall through
+      default:
+        goto usage;
+    }
+  }
+
+  if (argc - optind != 2)
    {
-      printf ("Usage: pi <number_threads> <number_samples>\n");
+usage:
+      printf ("Usage: pi [-k scalar|simd] [-g pcg|lcg] <number_threads> <number_samples>\n");
       return 1;
    }
    
   unsigned int num_threads;
-  unsigned int num_samples;
+  unsigned long long num_samples;
   
-  if (sscanf (argv[1],"%u",&num_threads) != 1)
+  if (sscanf (argv[optind],"%u",&num_threads) != 1)
   {
     fprintf (stderr, "<number_threads> has to be a positive integer\n");
     return 1;
   }
   
-  if (sscanf (argv[2],"%u",&num_samples) != 1)
+  if (sscanf (argv[optind + 1],"%llu",&num_samples) != 1)
   {
     fprintf (stderr, "<number_samples> has to be a positive integer\n");
     return 1;
   }
   
-  int k;
-  #pragma omp parallel for schedule(static) private(k) reduction(+:circle_hits) num_threads(num_threads)
-  for (k = 0; k < num_samples; k++)
-  {  
-    double x = pr_random_f(CIRCLE_RADIUS);
-    double y = pr_random_f(CIRCLE_RADIUS);
- 
-    if (((x * x) + (y * y)) <= 1)
+  if (use_simd)
+  {
+    long long blocks = (num_samples + SIMD_BLOCK - 1) / SIMD_BLOCK;
+    long long b;
+
+    // the blocks are independent, sample k is the same as in the scalar loop
+    #pragma omp parallel for schedule(static) reduction(+:circle_hits) num_threads(num_threads)
+    for (b = 0; b < blocks; b++)
+    {
+      unsigned long long first = b * SIMD_BLOCK;
+      long long samples = (num_samples - first < SIMD_BLOCK) ? num_samples - first : SIMD_BLOCK;
+
+      circle_hits += use_pcg ? simd_circle_hits_pcg(first, samples) : simd_circle_hits(first, samples);
+    }
+  }
+  else if (use_pcg)
+  #pragma omp parallel reduction(+:circle_hits) num_threads(num_threads)
+  {
+    pr_pcg_state random_state;
+    long long next_sample = -1;
+    long long k;
+
+    #pragma omp for schedule(static)
+    for (k = 0; k < num_samples; k++)
     {
-      circle_hits++;
-    } 
+      // as below, with the upper 31 bits of the numbers: hit if
+      // x^2 + y^2 <= 2^62, like simd_circle_hits_pcg
+      if (k != next_sample)
+      {
+        pr_pcg_seed(&random_state, PR_PCG_SEED, PR_PCG_STREAM);
+        pr_pcg_skip(&random_state, 2 * (unsigned long long) k);
+      }
+      next_sample = k + 1;
+
+      long long x = pr_pcg_r(&random_state) >> 1;
+      long long y = pr_pcg_r(&random_state) >> 1;
+
+      circle_hits += (x * x + y * y <= (1LL << 62));
+    }
+  }
+  else
+  #pragma omp parallel reduction(+:circle_hits) num_threads(num_threads)
+  {
+    pr_random_state random_state;
+    long long next_sample = -1;
+    long long k;
+
+    #pragma omp for schedule(static)
+    for (k = 0; k < num_samples; k++)
+    {  
+      // sample k uses the numbers 2k and 2k + 1 of the sequence: at the
+      // start of each chunk of this thread the private state jumps there,
+      // so the hits do not depend on the number of threads
+      if (k != next_sample)
+      {
+        pr_random_seed(&random_state, 0);
+        pr_random_skip(&random_state, 2 * (unsigned long long) k);
+      }
+      next_sample = k + 1;
+
+      double x = pr_random_f_r(&random_state, CIRCLE_RADIUS);
+      double y = pr_random_f_r(&random_state, CIRCLE_RADIUS);
+ 
+      if (((x * x) + (y * y)) <= 1)
+      {
+        circle_hits++;
+      } 
+    }
   }
   
   /*#pragma omp parallel num_threads(num_threads)
@@ -81,7 +175,7 @@ main (int argc, char** argv)
     printf ("number of parallel threads: %d\n", omp_get_num_threads());
   }*/
   
-  double pi = ((double) circle_hits / num_samples) * 4;
+  double pi = ((double) circle_hits / (double) num_samples) * 4;
   printf ("estimation of pi: %f\n", pi);
 
   double relative_error = ((pi - M_PI) / M_PI);
@@ -0,0 +1,177 @@
+#include "random.h"
+#include "simd.h"
+
+/* one AVX2 register of doubles per vector; the LCG steps of a vector
+ * depend on each other, so several independent chains hide the latency
+ */
+#define SIMD_WIDTH 4
+#define SIMD_CHAINS 4
+#define SIMD_LANES (SIMD_WIDTH * SIMD_CHAINS)
+
+typedef double vdouble __attribute__ ((vector_size (SIMD_WIDTH * sizeof (double))));
+typedef long long vlong __attribute__ ((vector_size (SIMD_WIDTH * sizeof (long long))));
+typedef int vint __attribute__ ((vector_size (SIMD_WIDTH * sizeof (int))));
+typedef unsigned long long vulong __attribute__ ((vector_size (SIMD_WIDTH * sizeof (unsigned long long))));
+
+/* AVX2 clone selected at load time where available */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define SIMD_CLONES __attribute__ ((target_clones ("avx2", "default")))
+#else
+#define SIMD_CLONES
+#endif
+
+/* one stride step of every lane: (a * x + c) % PR_RANDOM_MOD.
+ * the product is below 2^40 and thus exact; the quotient estimated with
+ * the reciprocal is off by at most one, which the two corrections fix.
+ */
+static inline void
+lcg_step (vdouble *x, double a, double c)
+{
+  const double mod = PR_RANDOM_MOD;
+  const vdouble mods = mod - (vdouble) {0};
+  vdouble p = *x * a + c;
+  vdouble q = __builtin_convertvector (__builtin_convertvector (p * (1.0 / mod), vint), vdouble);
+  vdouble r = p - q * mod;
+
+  // the compares give all bits set for true, selecting mod or 0.0
+  r += (vdouble) ((vlong) mods & (r < 0));
+  r -= (vdouble) ((vlong) mods & (r >= mods));
+
+  *x = r;
+}
+
+SIMD_CLONES long long
+simd_circle_hits (unsigned long long first, long long samples)
+{
+  const double limit = (double) PR_RANDOM_MOD * PR_RANDOM_MOD;
+  pr_random_state random_state;
+  vdouble x[SIMD_CHAINS], y[SIMD_CHAINS];
+  vlong hits[SIMD_CHAINS] = {{0}};
+  long long blocks = samples / SIMD_LANES;
+  long long b, k, result = 0;
+  int a, c, i, j;
+
+  // lane j of chain i starts with the sample first + i * SIMD_WIDTH + j
+  pr_random_seed (&random_state, 0);
+  pr_random_skip (&random_state, 2 * first);
+  for (i = 0; i < SIMD_CHAINS; i++)
+  {
+    for (j = 0; j < SIMD_WIDTH; j++)
+    {
+      x[i][j] = pr_random_r (&random_state);
+      y[i][j] = pr_random_r (&random_state);
+    }
+  }
+
+  // and moves on by SIMD_LANES samples per step
+  pr_random_stride (2 * SIMD_LANES, &a, &c);
+
+  for (b = 0; b < blocks; b++)
+  {
+    for (i = 0; i < SIMD_CHAINS; i++)
+    {
+      hits[i] -= (x[i] * x[i] + y[i] * y[i] <= limit);
+
+      lcg_step (&x[i], a, c);
+      lcg_step (&y[i], a, c);
+    }
+  }
+
+  for (i = 0; i < SIMD_CHAINS; i++)
+  {
+    for (j = 0; j < SIMD_WIDTH; j++)
+    {
+      result += hits[i][j];
+    }
+  }
+
+  // remaining samples
+  pr_random_seed (&random_state, 0);
+  pr_random_skip (&random_state, 2 * (first + blocks * SIMD_LANES));
+  for (k = blocks * SIMD_LANES; k < samples; k++)
+  {
+    long long r1 = pr_random_r (&random_state);
+    long long r2 = pr_random_r (&random_state);
+
+    result += (r1 * r1 + r2 * r2 <= (long long) PR_RANDOM_MOD * PR_RANDOM_MOD);
+  }
+
+  return result;
+}
+
+/* output of the PCG32 steps of every lane, 31 bits, and the next states */
+static inline void
+pcg_step (vulong *state, vlong *r, unsigned long long a, unsigned long long c)
+{
+  vulong old = *state;
+  vulong xorshifted = (((old >> 18) ^ old) >> 27) & 0xffffffffULL;
+  vulong rot = old >> 59;
+  vulong out = ((xorshifted >> rot) | (xorshifted << ((32 - rot) & 31))) & 0xffffffffULL;
+
+  *state = old * a + c;
+  *r = (vlong) (out >> 1);
+}
+
+SIMD_CLONES long long
+simd_circle_hits_pcg (unsigned long long first, long long samples)
+{
+  const long long limit = 1LL << 62;
+  pr_pcg_state random_state;
+  vulong x[SIMD_CHAINS], y[SIMD_CHAINS];
+  vlong hits[SIMD_CHAINS] = {{0}};
+  long long blocks = samples / SIMD_LANES;
+  long long b, k, result = 0;
+  unsigned long long a, c;
+  int i, j;
+
+  // the states of the numbers 2k and 2k + 1 of the lanes, which then
+  // step on by 2 * SIMD_LANES numbers
+  pr_pcg_seed (&random_state, PR_PCG_SEED, PR_PCG_STREAM);
+  pr_pcg_skip (&random_state, 2 * first);
+  for (i = 0; i < SIMD_CHAINS; i++)
+  {
+    for (j = 0; j < SIMD_WIDTH; j++)
+    {
+      x[i][j] = random_state.state;
+      pr_pcg_r (&random_state);
+      y[i][j] = random_state.state;
+      pr_pcg_r (&random_state);
+    }
+  }
+
+  pr_pcg_stride (&random_state, 2 * SIMD_LANES, &a, &c);
+
+  for (b = 0; b < blocks; b++)
+  {
+    for (i = 0; i < SIMD_CHAINS; i++)
+    {
+      vlong rx, ry;
+
+      pcg_step (&x[i], &rx, a, c);
+      pcg_step (&y[i], &ry, a, c);
+
+      hits[i] -= (rx * rx + ry * ry <= limit);
+    }
+  }
+
+  for (i = 0; i < SIMD_CHAINS; i++)
+  {
+    for (j = 0; j < SIMD_WIDTH; j++)
+    {
+      result += hits[i][j];
+    }
+  }
+
+  // remaining samples
+  pr_pcg_seed (&random_state, PR_PCG_SEED, PR_PCG_STREAM);
+  pr_pcg_skip (&random_state, 2 * (first + blocks * SIMD_LANES));
+  for (k = blocks * SIMD_LANES; k < samples; k++)
+  {
+    long long r1 = pr_pcg_r (&random_state) >> 1;
+    long long r2 = pr_pcg_r (&random_state) >> 1;
+
+    result += (r1 * r1 + r2 * r2 <= limit);
+  }
+
+  return result;
+}
@@ -0,0 +1,784 @@
+#include "estimator.h"
+#include "random.h"
+#include "simd.h"
+#include "halton.h"
+#include "perfcount.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <pthread.h>
+
+#define CIRCLE_RADIUS 1
+
+// size of a cache line, the result slots of the threads are padded to it
+#define CACHE_LINE 64
+
+// hits and samples of the chunks a thread finished, written only by the
+// thread, read by the others (atomics) to check the target of a job
+typedef struct
+{
+  long long hits;
+  long long samples;
+  double squares;       // for the variance of the method, see pi_job_variance
+} __attribute__ ((aligned (CACHE_LINE))) pi_slot;
+
+// chunks lo .. hi - 1 of a job left to a thread: the owner takes them
+// from the front, other threads steal from the back
+typedef struct
+{
+  pthread_mutex_t lock;
+  long long lo, hi;
+} __attribute__ ((aligned (CACHE_LINE))) pi_deque;
+
+struct pi_job
+{
+  pi_pool *pool;
+  long long first_sample;
+  long long samples;
+  pi_kernel kernel;
+  pi_generator generator;
+  int replicate;          // random shift of PI_QMC_HALTON
+  pi_method method;
+  long long strata_side;  // PI_STRATIFIED: strata_side^2 strata of PI_STRATUM_SAMPLES
+  pi_callback callback;
+  void *user;
+
+  // one slot and one deque per thread
+  pi_slot *slots;
+  pi_deque *deques;
+  long long chunks;
+  long long chunks_left;  // chunks not finished or dropped yet, atomic
+  double target;          // relative error to stop at, 0 for all samples
+  int stop;               // target reached, atomic
+  int users;              // threads working on the job
+  int done;
+  long long hits;
+  long long samples_done;
+  double squares;
+
+  pi_job *next;
+};
+
+struct pi_pool
+{
+  pthread_t *tid;
+  int threads;
+
+  pthread_mutex_t lock;
+  pthread_cond_t work;  // a job was submitted or the pool stops
+  pthread_cond_t done;  // a job is done or was left by a thread
+
+  // pending jobs, the first one still has chunks to hand out
+  pi_job *head, **tail;
+  int stop;
+  int next_id;
+};
+
+
+static int
+circle_hit(double x, double y)
+{
+  return ((x * x) + (y * y) <= 1);
+}
+
+// with PCG32 the upper 31 bits of the numbers, hit if x^2 + y^2 <= 2^62,
+// like simd_circle_hits_pcg
+static long long
+count_hits_pcg (long long first_sample, long long samples)
+{
+  const long long limit = 1LL << 62;
+  pr_pcg_state random_state;
+  long long local_circle_hits = 0;
+  long long k;
+
+  pr_pcg_seed(&random_state, PR_PCG_SEED, PR_PCG_STREAM);
+  pr_pcg_skip(&random_state, 2 * (unsigned long long) first_sample);
+
+  for (k = 0; k < samples; k++)
+  {
+    long long x = pr_pcg_r(&random_state) >> 1;
+    long long y = pr_pcg_r(&random_state) >> 1;
+
+    local_circle_hits += (x * x + y * y <= limit);
+  }
+
+  return local_circle_hits;
+}
+
+// the points of the Halton sequence in bases 2 and 3, shifted modulo 1
+// by the random vector of the replicate (Cranley-Patterson rotation):
+// every replicate is an unbiased estimate, and their spread gives the
+// error, which the deterministic points alone would not
+static long long
+count_hits_halton (int replicate, long long first_sample, long long samples)
+{
+  pr_pcg_state random_state;
+  halton_state hx, hy;
+  long long local_circle_hits = 0;
+  long long k;
+
+  pr_pcg_seed(&random_state, PR_PCG_SEED, replicate);
+  double shift_x = pr_pcg_r(&random_state) / 4294967296.0;
+  double shift_y = pr_pcg_r(&random_state) / 4294967296.0;
+
+  halton_seek(&hx, 2, first_sample);
+  halton_seek(&hy, 3, first_sample);
+
+  for (k = 0; k < samples; k++)
+  {
+    double x = halton_next(&hx) + shift_x;
+    double y = halton_next(&hy) + shift_y;
+
+    x -= (x >= 1);
+    y -= (y >= 1);
+    local_circle_hits += circle_hit(x, y);
+  }
+
+  return local_circle_hits;
+}
+
+// uniform number in [0, 1) from the upper 31 bits of PCG32, like the
+// kernels of PI_RNG_PCG
+static double
+pcg_uniform (pr_pcg_state *random_state)
+{
+  return (pr_pcg_r(random_state) >> 1) * (1.0 / 2147483648.0);
+}
+
+// pairs of samples 2p, 2p + 1: (x, y) from the numbers 2p and 2p + 1 and
+// its mirror image (1 - x, 1 - y). The two hits are negatively
+// correlated, so their mean varies less than that of two independent
+// samples; squares gets the sum of (h1 + h2)^2 of the pairs
+static long long
+count_hits_antithetic (long long first_sample, long long samples, double *squares)
+{
+  pr_pcg_state random_state;
+  long long local_circle_hits = 0;
+  long long p;
+
+  pr_pcg_seed(&random_state, PR_PCG_SEED, PR_PCG_STREAM);
+  pr_pcg_skip(&random_state, (unsigned long long) first_sample);
+
+  for (p = 0; p < samples / 2; p++)
+  {
+    double x = pcg_uniform(&random_state);
+    double y = pcg_uniform(&random_state);
+    int pair_hits = circle_hit(x, y) + circle_hit(1 - x, 1 - y);
+
+    local_circle_hits += pair_hits;
+    *squares += pair_hits * pair_hits;
+  }
+
+  return local_circle_hits;
+}
+
+// sample k of the job lies in the stratum k / PI_STRATUM_SAMPLES of the
+// grid of side x side sub-squares, at the offset given by the numbers 2k
+// and 2k + 1 (k counted from 0 for the grid, from the first sample of
+// the job for the numbers). The chunks hold whole strata; squares gets
+// the sum of the estimated variances p (1 - p) n / (n - 1) of the hit of
+// a sample in the strata
+static long long
+count_hits_stratified (long long side, long long job_first, long long first_sample,
+                       long long samples, double *squares)
+{
+  const int n = PI_STRATUM_SAMPLES;
+  pr_pcg_state random_state;
+  long long local_circle_hits = 0;
+  long long stratum;
+  int t;
+
+  pr_pcg_seed(&random_state, PR_PCG_SEED, PR_PCG_STREAM);
+  pr_pcg_skip(&random_state, 2 * (unsigned long long) (job_first + first_sample));
+
+  for (stratum = first_sample / n; stratum < (first_sample + samples) / n; stratum++)
+  {
+    double x0 = (double) (stratum % side), y0 = (double) (stratum / side);
+    int stratum_hits = 0;
+
+    for (t = 0; t < n; t++)
+    {
+      double x = (x0 + pcg_uniform(&random_state)) / side;
+      double y = (y0 + pcg_uniform(&random_state)) / side;
+
+      stratum_hits += circle_hit(x, y);
+    }
+
+    local_circle_hits += stratum_hits;
+    *squares += (double) stratum_hits * (n - stratum_hits) / ((double) n * (n - 1));
+  }
+
+  return local_circle_hits;
+}
+
+static long long
+count_hits (const pi_job *job, long long first_sample, long long samples, double *squares)
+{
+  pi_kernel kernel = job->kernel;
+  pi_generator generator = job->generator;
+  pr_random_state random_state;
+  long long local_circle_hits = 0;
+  long long k;
+
+  if (job->method == PI_ANTITHETIC)
+  {
+    return count_hits_antithetic(first_sample, samples, squares);
+  }
+
+  if (job->method == PI_STRATIFIED)
+  {
+    return count_hits_stratified(job->strata_side, job->first_sample,
+                                 first_sample - job->first_sample, samples, squares);
+  }
+
+  if (generator == PI_QMC_HALTON)
+  {
+    return count_hits_halton(job->replicate, first_sample, samples);
+  }
+
+  if (generator == PI_RNG_PCG)
+  {
+    return (kernel == PI_KERNEL_SIMD) ? simd_circle_hits_pcg(first_sample, samples)
+                                      : count_hits_pcg(first_sample, samples);
+  }
+
+  if (kernel == PI_KERNEL_SIMD)
+  {
+    return simd_circle_hits(first_sample, samples);
+  }
+
+  // sample k uses the numbers 2k and 2k + 1 of the sequence
+  pr_random_seed(&random_state, 0);
+  pr_random_skip(&random_state, 2 * (unsigned long long) first_sample);
+
+  for (k = 0; k < samples; k++)
+  {
+    double x = pr_random_f_r(&random_state, CIRCLE_RADIUS);
+    double y = pr_random_f_r(&random_state, CIRCLE_RADIUS);
+
+    if (circle_hit(x,y))
+    {
+      local_circle_hits ++;
+    }
+  }
+
+  return local_circle_hits;
+}
+
+// half width of the 95% confidence interval of the estimate 4 * hits / samples
+// of independent samples
+static double
+confidence (long long hits, long long samples)
+{
+  double p = (double) hits / samples;
+
+  return PI_CONFIDENCE_Z * 4 * sqrt(p * (1 - p) / samples);
+}
+
+// n chunks are finished or dropped, the last ones complete the job
+static void
+chunks_finished (pi_job *job, long long n)
+{
+  int i;
+
+  if (n == 0 || __atomic_sub_fetch(&job->chunks_left, n, __ATOMIC_ACQ_REL) != 0)
+  {
+    return;
+  }
+
+  for (i = 0; i < job->pool->threads; i++)
+  {
+    job->hits += job->slots[i].hits;
+    job->samples_done += job->slots[i].samples;
+    job->squares += job->slots[i].squares;
+  }
+
+  if (job->callback)
+  {
+    job->callback(job, job->user);
+  }
+
+  pthread_mutex_lock(&job->pool->lock);
+  job->done = 1;
+  pthread_cond_broadcast(&job->pool->done);
+  pthread_mutex_unlock(&job->pool->lock);
+}
+
+// chunks of a deque that are not taken yet, dropped once the job stops
+static long long
+drop_chunks (pi_deque *deque)
+{
+  long long n;
+
+  pthread_mutex_lock(&deque->lock);
+  n = deque->hi - deque->lo;
+  deque->lo = deque->hi;
+  pthread_mutex_unlock(&deque->lock);
+
+  return n;
+}
+
+// the thread that finished a chunk acts as coordinator: from the counts
+// published by all threads it computes the running estimate and stops
+// the job once the confidence interval is narrow enough. The counts of
+// the slots are read one after the other, so they may be a chunk apart;
+// the final result is summed only after all threads are done.
+static void
+check_target (pi_job *job)
+{
+  long long hits = 0, samples = 0;
+  int i;
+
+  for (i = 0; i < job->pool->threads; i++)
+  {
+    hits += __atomic_load_n(&job->slots[i].hits, __ATOMIC_RELAXED);
+    samples += __atomic_load_n(&job->slots[i].samples, __ATOMIC_RELAXED);
+  }
+
+  if (samples == 0 || hits == 0 ||
+      confidence(hits, samples) > job->target * 4 * hits / samples)
+  {
+    return;
+  }
+
+  if (__atomic_exchange_n(&job->stop, 1, __ATOMIC_ACQ_REL) == 0)
+  {
+    long long dropped = 0;
+
+    for (i = 0; i < job->pool->threads; i++)
+    {
+      dropped += drop_chunks(&job->deques[i]);
+    }
+    chunks_finished(job, dropped);
+  }
+}
+
+// next chunk for thread id: from its own deque, or else half of the
+// chunks left in the deque of another thread; -1 if there are none
+static long long
+next_chunk (pi_job *job, int id)
+{
+  int threads = job->pool->threads;
+  pi_deque *own = &job->deques[id];
+  long long chunk = -1;
+  int i;
+
+  // chunks stolen before the job stopped
+  if (__atomic_load_n(&job->stop, __ATOMIC_ACQUIRE))
+  {
+    chunks_finished(job, drop_chunks(own));
+    return -1;
+  }
+
+  pthread_mutex_lock(&own->lock);
+  if (own->lo < own->hi)
+  {
+    chunk = own->lo++;
+  }
+  pthread_mutex_unlock(&own->lock);
+
+  for (i = 1; i < threads && chunk < 0; i++)
+  {
+    pi_deque *victim = &job->deques[(id + i) % threads];
+    long long lo = 0, hi = 0;
+
+    pthread_mutex_lock(&victim->lock);
+    if (victim->lo < victim->hi)
+    {
+      hi = victim->hi;
+      lo = hi - (hi - victim->lo + 1) / 2;
+      victim->hi = lo;
+    }
+    pthread_mutex_unlock(&victim->lock);
+
+    if (lo < hi)
+    {
+      pthread_mutex_lock(&own->lock);
+      own->lo = lo + 1;
+      own->hi = hi;
+      pthread_mutex_unlock(&own->lock);
+      chunk = lo;
+    }
+  }
+
+  return chunk;
+}
+
+// work on the chunks of job until none are left to take or steal
+static void
+run_job (pi_job *job, int id)
+{
+  long long chunk, units = 0;
+
+  perfBegin("chunks");
+
+  while ((chunk = next_chunk(job, id)) >= 0)
+  {
+    // each chunk is its own substream, starting at its first sample, and
+    // the hits are summed as integers: the result does not depend on
+    // the thread that ran the chunk
+    long long first = chunk * PI_CHUNK;
+    long long samples = (job->samples - first < PI_CHUNK) ? job->samples - first : PI_CHUNK;
+
+    pi_slot *slot = &job->slots[id];
+    long long hits = count_hits(job, job->first_sample + first, samples, &slot->squares);
+
+    // publish the counts of the chunk
+    __atomic_store_n(&slot->hits, slot->hits + hits, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->samples, slot->samples + samples, __ATOMIC_RELAXED);
+    units += samples;
+
+    if (job->target > 0)
+    {
+      check_target(job);
+    }
+
+    chunks_finished(job, 1);
+  }
+
+  perfEnd("chunks", units);
+}
+
+static void *
+worker (void * arg)
+{
+  pi_pool *pool = (pi_pool *) arg;
+  int id;
+
+  pthread_mutex_lock(&pool->lock);
+  id = pool->next_id++;
+
+  for (;;)
+  {
+    while (!pool->head && !pool->stop)
+    {
+      pthread_cond_wait(&pool->work, &pool->lock);
+    }
+    if (!pool->head)
+    {
+      break;
+    }
+
+    pi_job *job = pool->head;
+    job->users++;
+    pthread_mutex_unlock(&pool->lock);
+
+    run_job(job, id);
+
+    pthread_mutex_lock(&pool->lock);
+
+    // all chunks are taken, the next threads go on with the next job
+    if (pool->head == job)
+    {
+      pool->head = job->next;
+      if (!pool->head)
+      {
+        pool->tail = &pool->head;
+      }
+    }
+
+    job->users--;
+    pthread_cond_broadcast(&pool->done);
+  }
+
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+pi_pool *
+pi_pool_create(int threads)
+{
+  pi_pool *pool;
+  int i;
+
+  if (threads < 1)
+  {
+    return NULL;
+  }
+
+  if ((pool = (pi_pool *) malloc(sizeof(pi_pool))) == NULL ||
+      (pool->tid = (pthread_t *) malloc(sizeof(pthread_t) * threads)) == NULL)
+  {
+    printf("Error allocating requested memory.\n");
+    exit(1);
+  }
+
+  pool->threads = threads;
+  pool->head = NULL;
+  pool->tail = &pool->head;
+  pool->stop = 0;
+  pool->next_id = 0;
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->work, NULL);
+  pthread_cond_init(&pool->done, NULL);
+
+  for (i = 0; i < threads; i++)
+  {
+    if (pthread_create(&pool->tid[i], NULL, &worker, (void *) pool) != 0)
+    {
+      fprintf(stderr, "cannot create worker thread\n");
+      exit(1);
+    }
+  }
+
+  return pool;
+}
+
+void
+pi_pool_destroy(pi_pool *pool)
+{
+  int i;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = 1;
+  pthread_cond_broadcast(&pool->work);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (i = 0; i < pool->threads; i++)
+  {
+    pthread_join(pool->tid[i], NULL);
+  }
+
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->work);
+  pthread_cond_destroy(&pool->done);
+  free(pool->tid);
+  free(pool);
+}
+
+static pi_job *
+submit (pi_pool *pool, long long first_sample, long long samples, double target,
+        pi_kernel kernel, pi_generator generator, int replicate, pi_method method,
+        pi_callback callback, void *user)
+{
+  int threads = pool->threads;
+  pi_job *job;
+  int i;
+
+  if ((job = (pi_job *) malloc(sizeof(pi_job))) == NULL ||
+      posix_memalign((void **) &job->slots, CACHE_LINE, sizeof(pi_slot) * threads) != 0 ||
+      posix_memalign((void **) &job->deques, CACHE_LINE, sizeof(pi_deque) * threads) != 0)
+  {
+    printf("Error allocating requested memory.\n");
+    exit(1);
+  }
+
+  job->pool = pool;
+  job->first_sample = first_sample;
+  job->samples = samples;
+  job->kernel = kernel;
+  job->generator = generator;
+  job->replicate = replicate;
+  job->method = method;
+  job->strata_side = 0;
+  job->callback = callback;
+  job->user = user;
+  job->target = target;
+  job->stop = 0;
+  job->users = 0;
+  job->done = 0;
+  job->hits = 0;
+  job->samples_done = 0;
+  job->squares = 0;
+  job->next = NULL;
+
+  // whole pairs, whole strata: as many samples as fit
+  if (method == PI_ANTITHETIC)
+  {
+    job->samples = samples - samples % 2;
+  }
+  if (method == PI_STRATIFIED)
+  {
+    job->strata_side = (long long) sqrt((double) (samples / PI_STRATUM_SAMPLES));
+    while ((job->strata_side + 1) * (job->strata_side + 1) * PI_STRATUM_SAMPLES <= samples)
+    {
+      job->strata_side++;
+    }
+    while (job->strata_side * job->strata_side * PI_STRATUM_SAMPLES > samples)
+    {
+      job->strata_side--;
+    }
+    job->samples = job->strata_side * job->strata_side * PI_STRATUM_SAMPLES;
+  }
+  job->chunks = (job->samples + PI_CHUNK - 1) / PI_CHUNK;
+  job->chunks_left = job->chunks;
+
+  // the chunks start out as contiguous blocks, one per thread
+  for (i = 0; i < threads; i++)
+  {
+    pthread_mutex_init(&job->deques[i].lock, NULL);
+    job->deques[i].lo = job->chunks * i / threads;
+    job->deques[i].hi = job->chunks * (i + 1) / threads;
+    job->slots[i].hits = 0;
+    job->slots[i].samples = 0;
+    job->slots[i].squares = 0;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  if (job->chunks == 0)
+  {
+    job->done = 1;
+    pthread_mutex_unlock(&pool->lock);
+    if (callback)
+    {
+      callback(job, user);
+    }
+    return job;
+  }
+  *pool->tail = job;
+  pool->tail = &job->next;
+  pthread_cond_broadcast(&pool->work);
+  pthread_mutex_unlock(&pool->lock);
+
+  return job;
+}
+
+pi_job *
+pi_pool_submit(pi_pool *pool, long long first_sample, long long samples,
+               pi_kernel kernel, pi_generator generator,
+               pi_callback callback, void *user)
+{
+  return pi_pool_submit_target(pool, first_sample, samples, 0, kernel, generator,
+                               callback, user);
+}
+
+pi_job *
+pi_pool_submit_target(pi_pool *pool, long long first_sample, long long samples,
+                      double target, pi_kernel kernel, pi_generator generator,
+                      pi_callback callback, void *user)
+{
+  return submit(pool, first_sample, samples, target, kernel, generator, 0, PI_PLAIN,
+                callback, user);
+}
+
+pi_job *
+pi_pool_submit_qmc(pi_pool *pool, int replicate, long long first_sample, long long samples,
+                   pi_callback callback, void *user)
+{
+  return submit(pool, first_sample, samples, 0, PI_KERNEL_SCALAR, PI_QMC_HALTON, replicate,
+                PI_PLAIN, callback, user);
+}
+
+pi_job *
+pi_pool_submit_method(pi_pool *pool, pi_method method, long long first_sample, long long samples,
+                      pi_callback callback, void *user)
+{
+  return submit(pool, first_sample, samples, 0, PI_KERNEL_SCALAR, PI_RNG_PCG, 0, method,
+                callback, user);
+}
+
+int
+pi_job_done(pi_job *job)
+{
+  int done;
+
+  pthread_mutex_lock(&job->pool->lock);
+  done = job->done;
+  pthread_mutex_unlock(&job->pool->lock);
+
+  return done;
+}
+
+double
+pi_job_wait(pi_job *job)
+{
+  pi_pool *pool = job->pool;
+
+  pthread_mutex_lock(&pool->lock);
+  while (!job->done)
+  {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  return pi_job_estimate(job);
+}
+
+double
+pi_job_estimate(const pi_job *job)
+{
+  return ((double) job->hits / job->samples_done) * 4;
+}
+
+double
+pi_job_variance(const pi_job *job)
+{
+  double n = (double) job->samples_done;
+
+  switch (job->method)
+  {
+    case PI_ANTITHETIC:
+    {
+      // pair means g = (h1 + h2) / 2, the estimate is 4 times their mean
+      double pairs = n / 2;
+      double mean = job->hits / n;
+
+      if (pairs < 2)
+      {
+        return 0;
+      }
+      double variance = (job->squares / 4 - pairs * mean * mean) / (pairs - 1);
+
+      return 16 * variance / pairs;
+    }
+    case PI_STRATIFIED:
+    {
+      // the estimate is 4 times the mean of the strata, each the mean of
+      // PI_STRATUM_SAMPLES samples
+      double strata = n / PI_STRATUM_SAMPLES;
+
+      if (strata < 1)
+      {
+        return 0;
+      }
+      return 16 * job->squares / (strata * strata * PI_STRATUM_SAMPLES);
+    }
+    default:
+    {
+      double p = job->hits / n;
+
+      return 16 * p * (1 - p) / n;
+    }
+  }
+}
+
+double
+pi_job_confidence(const pi_job *job)
+{
+  return PI_CONFIDENCE_Z * sqrt(pi_job_variance(job));
+}
+
+long long
+pi_job_hits(const pi_job *job)
+{
+  return job->hits;
+}
+
+long long
+pi_job_samples(const pi_job *job)
+{
+  return job->samples_done;
+}
+
+void
+pi_job_free(pi_job *job)
+{
+  pi_pool *pool = job->pool;
+  int i;
+
+  // threads may still be looking for chunks to steal
+  pthread_mutex_lock(&pool->lock);
+  while (!job->done || job->users > 0)
+  {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  for (i = 0; i < pool->threads; i++)
+  {
+    pthread_mutex_destroy(&job->deques[i].lock);
+  }
+  free(job->deques);
+  free(job->slots);
+  free(job);
+}
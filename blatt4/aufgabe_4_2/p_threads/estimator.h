@@ -0,0 +1,141 @@
+#ifndef ESTIMATOR_H
+#define ESTIMATOR_H
+
+/* Monte Carlo estimation of pi on a persistent pool of worker threads.
+ *
+ * The threads are started once in pi_pool_create and wait for jobs. A
+ * job is split into chunks of PI_CHUNK samples, each thread starts with
+ * a contiguous block of them in its own deque and, once that is empty,
+ * steals half of the chunks left to another thread, so slow or
+ * oversubscribed threads do not hold up the job. Sample k of the job
+ * always uses the random numbers 2k and 2k + 1 of the generator (counted
+ * from first_sample), every chunk jumping ahead to its own substream, so the
+ * estimate depends neither on the number of threads nor on which thread
+ * ran which chunk.
+ *
+ *     pi_pool *pool = pi_pool_create(8);
+ *     pi_job *job = pi_pool_submit(pool, 0, 1000000, PI_KERNEL_SIMD, PI_RNG_PCG,
+ *                                  NULL, NULL);
+ *     double pi = pi_job_wait(job);
+ *     pi_job_free(job);
+ *     ...
+ *     pi_pool_destroy(pool);
+ *
+ * Jobs are run in the order of submission, several jobs may be pending
+ * at once.
+ */
+
+// samples per chunk, a multiple of the lanes of the SIMD kernel
+#define PI_CHUNK 65536
+
+typedef enum
+{
+  PI_KERNEL_SCALAR,
+  PI_KERNEL_SIMD
+} pi_kernel;
+
+/* PI_RNG_LCG is pr_random, which repeats after 714025 numbers, i.e.
+ * 357012 samples; PI_RNG_PCG is the long period pr_pcg_r. PI_QMC_HALTON
+ * is no random generator but the quasi-random points of the Halton
+ * sequence, see pi_pool_submit_qmc.
+ */
+typedef enum
+{
+  PI_RNG_LCG,
+  PI_RNG_PCG,
+  PI_QMC_HALTON
+} pi_generator;
+
+/* how the samples are drawn, all with the numbers of pr_pcg_r:
+ * PI_PLAIN       independent uniform points, the hits counted by circle_hit
+ * PI_STRATIFIED  the unit square is divided into a grid of sub-squares
+ *                (strata) with PI_STRATUM_SAMPLES points each; the chunks,
+ *                and so the threads, get whole strata
+ * PI_ANTITHETIC  pairs of (x, y) and (1 - x, 1 - y)
+ */
+typedef enum
+{
+  PI_PLAIN,
+  PI_STRATIFIED,
+  PI_ANTITHETIC
+} pi_method;
+
+// quantile of the normal distribution for the 95% confidence interval
+#define PI_CONFIDENCE_Z 1.96
+
+// samples per stratum of PI_STRATIFIED, a divisor of PI_CHUNK
+#define PI_STRATUM_SAMPLES 8
+
+typedef struct pi_pool pi_pool;
+typedef struct pi_job pi_job;
+
+/* called by the worker thread finishing the job, once the result is
+ * available; must neither wait for nor free the job
+ */
+typedef void (*pi_callback)(pi_job *job, void *user);
+
+pi_pool *pi_pool_create(int threads);
+
+/* waits for the pending jobs and stops the threads */
+void pi_pool_destroy(pi_pool *pool);
+
+/* estimate pi from the samples first_sample .. first_sample + samples - 1,
+ * callback may be NULL. The job belongs to the caller and has to be
+ * released with pi_job_free.
+ */
+pi_job *pi_pool_submit(pi_pool *pool, long long first_sample, long long samples,
+                       pi_kernel kernel, pi_generator generator,
+                       pi_callback callback, void *user);
+
+/* the same, but stop as soon as the half width of the 95% confidence
+ * interval is at most target times the running estimate; samples is
+ * then only the maximum. The threads publish their counts after every
+ * chunk, so at most about one chunk per thread is computed in vain.
+ * Which chunks are used depends on the scheduling, the result is no
+ * longer the same for every number of threads.
+ */
+pi_job *pi_pool_submit_target(pi_pool *pool, long long first_sample, long long samples,
+                              double target, pi_kernel kernel, pi_generator generator,
+                              pi_callback callback, void *user);
+
+/* randomized quasi-Monte Carlo: the points first_sample .. of the Halton
+ * sequence in bases 2 and 3, shifted modulo 1 by a random vector chosen
+ * by replicate (Cranley-Patterson rotation). The error decreases about
+ * like (log n)^2 / n instead of 1 / sqrt(n); it is estimated from the
+ * spread of the estimates of several replicates with the same points.
+ * The chunks are index ranges of the sequence, so the estimate does not
+ * depend on the number of threads. Only the scalar kernel.
+ */
+pi_job *pi_pool_submit_qmc(pi_pool *pool, int replicate, long long first_sample, long long samples,
+                           pi_callback callback, void *user);
+
+/* estimate with a variance reduction method, scalar. The samples are
+ * rounded down to whole pairs (PI_ANTITHETIC) or to the largest square
+ * grid of strata (PI_STRATIFIED); pi_job_samples gives the samples used.
+ * The variance needs at least 2 pairs or 1 stratum, it is 0 below.
+ */
+pi_job *pi_pool_submit_method(pi_pool *pool, pi_method method, long long first_sample,
+                              long long samples, pi_callback callback, void *user);
+
+/* 1 if the result is available */
+int pi_job_done(pi_job *job);
+
+/* blocks until the job is done and returns the estimate */
+double pi_job_wait(pi_job *job);
+
+/* result of a done job (or in its callback): the estimate, its variance
+ * estimated from the samples of the method, the half width of the 95%
+ * confidence interval and the samples it is based on. For PI_QMC_HALTON
+ * the variance is the one of independent samples, far above the actual
+ * error; use the spread of the replicates instead.
+ */
+double pi_job_estimate(const pi_job *job);
+double pi_job_variance(const pi_job *job);
+double pi_job_confidence(const pi_job *job);
+long long pi_job_hits(const pi_job *job);
+long long pi_job_samples(const pi_job *job);
+
+/* waits for the job if it is not done yet */
+void pi_job_free(pi_job *job);
+
+#endif
@@ -0,0 +1,52 @@
+#include "halton.h"
+
+void halton_seek(halton_state *h, int base, unsigned long long k)
+{
+  unsigned long long p = 1;
+  int i;
+
+  // as many digits as base^digits fits into 64 bits
+  h->base = base;
+  h->digits = 0;
+  while (h->digits < HALTON_MAX_DIGITS && p <= ~0ULL / base)
+  {
+    p *= base;
+    h->digits++;
+  }
+  h->scale = 1.0 / (double) p;
+
+  for (i = 0; i < h->digits; i++)
+  {
+    p /= base;
+    h->power[i] = p;
+  }
+
+  h->value = 0;
+  for (i = 0; i < h->digits; i++)
+  {
+    h->d[i] = (int) (k % base);
+    h->value += h->d[i] * h->power[i];
+    k /= base;
+  }
+}
+
+double halton_next(halton_state *h)
+{
+  double x = h->value * h->scale;
+  int i;
+
+  // k + 1: the lowest digits that are base - 1 become 0, the next one
+  // is increased; the weights are mirrored, so the same happens in value
+  for (i = 0; i < h->digits && h->d[i] == h->base - 1; i++)
+  {
+    h->d[i] = 0;
+    h->value -= (unsigned long long) (h->base - 1) * h->power[i];
+  }
+  if (i < h->digits)
+  {
+    h->d[i]++;
+    h->value += h->power[i];
+  }
+
+  return x;
+}
@@ -0,0 +1,31 @@
+#ifndef HALTON_H
+#define HALTON_H
+
+/* Halton low discrepancy sequence: the k-th point has the coordinates
+ * phi_b(k), the radical inverse of k in base b (digits of k mirrored at
+ * the radix point), for a prime b per dimension.
+ *
+ * The digits are kept as an integer scaled by b^digits, so the update
+ * from k to k + 1 is exact and costs one step plus the carries on
+ * average. halton_seek jumps to any index, e.g. the first point of a
+ * chunk.
+ */
+
+#define HALTON_MAX_DIGITS 64
+
+typedef struct
+{
+  int base, digits;
+  int d[HALTON_MAX_DIGITS];                  // digits of k, lowest first
+  unsigned long long power[HALTON_MAX_DIGITS];  // base^(digits - 1 - i)
+  unsigned long long value;                  // phi_b(k) * base^digits
+  double scale;                              // base^-digits
+} halton_state;
+
+/* position h at point k of the sequence in base (a prime) */
+void halton_seek(halton_state *h, int base, unsigned long long k);
+
+/* phi_b(k) of the current point in [0, 1), then move on to k + 1 */
+double halton_next(halton_state *h);
+
+#endif
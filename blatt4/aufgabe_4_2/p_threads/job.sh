@@ -32,3 +32,24 @@ do
     ./pi $t $samples; 
   done
 done
+
+# target precision instead of a fixed number of samples: stop once the
+# 95% confidence interval is within 1e-5 of the estimate
+echo ""
+echo "Executing until a relative error of 1e-5 with 1,2,4,8,16 threads."
+
+for t in 1 2 4 8 16
+do
+  echo "threads $t"
+  ./pi -k simd -e 1e-5 $t 1000000000000
+done
+
+# variance reduction: compare the time to a given accuracy (variance * seconds)
+echo ""
+echo "Comparing the estimators with 8 threads."
+
+for m in plain stratified antithetic
+do
+  echo "method $m"
+  ./pi -m $m 8 $samples | grep variance
+done
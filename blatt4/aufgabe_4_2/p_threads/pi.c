@@ -1,51 +1,20 @@
-#include "random.h"
+#include "estimator.h"
+#include "perfcount.h"
 #include "math.h"
 #include <stdlib.h>
 #include <stdio.h>
-#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
 #include <time.h>
 
-#define THREAD_ARG 0
-#define CIRCLE_RADIUS 1
+// replicates of -g halton if -r is not given
+#define HALTON_REPLICATES 8
 
-static int circle_hits = 0;
-
-
-typedef struct
-{
-  int samples_to_compute;
-  int circle_hits_ret;
-} thread_arg;
-
-
-int
-circle_hit(double x, double y)
+// estimate of every run, printed by the callback of its job
+static void
+print_run (pi_job *job, void *user)
 {
-  return ((x * x) + (y * y) <= 1);
-}
-
-static void *
-thread_routine (void * arg)
-{
-  thread_arg *local_arg = (thread_arg *) arg;
-  int samples_to_compute = local_arg->samples_to_compute;
-  int local_circle_hits = 0;
-   
-  int k;
-  for (k = 0; k < samples_to_compute; k++)
-  {  
-    double x = pr_random_f(CIRCLE_RADIUS);
-    double y = pr_random_f(CIRCLE_RADIUS);
- 
-    if (circle_hit(x,y))
-    {
-      local_circle_hits ++;
-    }
-  }
-
-  local_arg->circle_hits_ret = local_circle_hits;  
-
-  pthread_exit(NULL);
+  printf ("run %d: estimation of pi: %f\n", *(int *) user, pi_job_estimate(job));
 }
 
 void 
@@ -81,75 +50,229 @@ main (int argc, char** argv)
     exit(1);
   }
 
-  if (argc != 3)
+  pi_kernel kernel = PI_KERNEL_SCALAR;
+  pi_generator generator = PI_RNG_PCG;
+  pi_method method = PI_PLAIN;
+  int runs = 0;
+  double target = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "k:g:r:e:m:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'm':
+        if (strcmp(optarg, "plain") == 0)
+        {
+          method = PI_PLAIN;
+          break;
+        }
+        if (strcmp(optarg, "stratified") == 0)
+        {
+          method = PI_STRATIFIED;
+          break;
+        }
+        if (strcmp(optarg, "antithetic") == 0)
+        {
+          method = PI_ANTITHETIC;
+          break;
+        }
+        goto usage;
+      case 'e':
+        if (sscanf (optarg, "%lf", &target) == 1 && target > 0)
+        {
+          break;
+        }
+        goto usage;
+      case 'g':
+        if (strcmp(optarg, "pcg") == 0)
+        {
+          generator = PI_RNG_PCG;
+          break;
+        }
+        if (strcmp(optarg, "lcg") == 0)
+        {
+          generator = PI_RNG_LCG;
+          break;
+        }
+        if (strcmp(optarg, "halton") == 0)
+        {
+          generator = PI_QMC_HALTON;
+          break;
+        }
+        goto usage;
+      case 'k':
+        if (strcmp(optarg, "simd") == 0)
+        {
+          kernel = PI_KERNEL_SIMD;
+          break;
+        }
+        if (strcmp(optarg, "scalar") == 0)
+        {
+          kernel = PI_KERNEL_SCALAR;
+          break;
+        }
+        goto usage;
+      case 'r':
+        if (sscanf (optarg, "%d", &runs) == 1 && runs > 0)
+        {
+          break;
+        }
+        // fall through
+      default:
+        goto usage;
+    }
+  }
+
+  // the random shifts of halton are the runs, the points are the same
+  if (runs == 0)
+  {
+    runs = (generator == PI_QMC_HALTON) ? HALTON_REPLICATES : 1;
+  }
+
+  // the variance reduction methods are scalar with pcg
+  if (argc - optind != 2 || (generator == PI_QMC_HALTON && target > 0) ||
+      (method != PI_PLAIN && (generator != PI_RNG_PCG || kernel != PI_KERNEL_SCALAR || target > 0)))
    {
-      printf ("Usage: pi <number_threads> <number_samples>\n");
+usage:
+      printf ("Usage: pi [-k scalar|simd] [-g pcg|lcg|halton] [-m plain|stratified|antithetic]\n"
+              "          [-r runs] [-e relative_error] <number_threads> <number_samples>\n");
       return 1;
    }
    
   unsigned long num_threads;
-  unsigned long num_samples;
+  unsigned long long num_samples;
   
-  if (sscanf (argv[1],"%lu",&num_threads) != 1)
+  if (sscanf (argv[optind],"%lu",&num_threads) != 1)
   {
     fprintf (stderr, "<number_threads> has to be a positive integer\n");
     return 1;
   }
   
-  if (sscanf (argv[2],"%lu",&num_samples) != 1)
+  if (sscanf (argv[optind + 1],"%llu",&num_samples) != 1)
   {
     fprintf (stderr, "<number_samples> has to be a positive integer\n");
     return 1;
   }
-   
-  printf ("start number_threads: %lu ,number_samples: %lu\n", num_threads, num_samples);
-  
-  // calculating number of samples per thread
-  int samples_per_thread = num_samples / num_threads;
-  int remaining_samples = num_samples % num_threads;
 
-  pthread_t *tid;
-  thread_arg *thread_args; 
+  // the methods round down to whole strata and pairs, the variance of
+  // antithetic needs at least two pairs
+  unsigned long long min_samples = (method == PI_STRATIFIED) ? PI_STRATUM_SAMPLES :
+                                   (method == PI_ANTITHETIC) ? 4 : 1;
+  if (num_samples < min_samples)
+  {
+    fprintf (stderr, "<number_samples> has to be at least %llu\n", min_samples);
+    return 1;
+  }
+   
+  printf ("start number_threads: %lu ,number_samples: %llu\n", num_threads, num_samples);
   
-  if ((tid = (pthread_t *) malloc(sizeof(pthread_t) * num_threads)) == NULL)
+  pi_pool *pool;
+  if (num_threads < 1 || (pool = pi_pool_create(num_threads)) == NULL)
   {
-    fprintf (stderr, "cannot allocate enough memory for pthread array\n");
+    fprintf (stderr, "<number_threads> has to be a positive integer\n");
     return 1;
   }
 
-  if ((thread_args = (thread_arg *) malloc(sizeof(thread_arg) * num_threads)) == NULL)
+  // the runs are queued at once and use consecutive samples, the threads
+  // are started only once for all of them
+  pi_job **jobs;
+  int *run_ids;
+
+  if ((jobs = (pi_job **) malloc(sizeof(pi_job *) * runs)) == NULL ||
+      (run_ids = (int *) malloc(sizeof(int) * runs)) == NULL)
   {
-    fprintf (stderr, "cannot allocate enough memory for pthread arguments array\n");
+    fprintf (stderr, "cannot allocate enough memory for the jobs\n");
     return 1;
   }
-  
+
+  struct timespec jobs_start, jobs_end, jobs_diff;
+  clock_gettime(CLOCK_MONOTONIC, &jobs_start);
+
   int i;
-  for (i = 0; i < num_threads; i++)
+  for (i = 0; i < runs; i++)
   {
-    thread_arg *current_arg = &thread_args[i];
-    current_arg->samples_to_compute = (remaining_samples > i) ? samples_per_thread + 1 : samples_per_thread;
-   
-    pthread_create (&tid[i], NULL, &thread_routine, (void *) current_arg);
+    run_ids[i] = i;
+    if (method != PI_PLAIN)
+    {
+      jobs[i] = pi_pool_submit_method(pool, method, (long long) i * num_samples, num_samples,
+                                      (runs > 1) ? print_run : NULL, &run_ids[i]);
+    }
+    else if (generator == PI_QMC_HALTON)
+    {
+      jobs[i] = pi_pool_submit_qmc(pool, i, 0, num_samples, print_run, &run_ids[i]);
+    }
+    else
+    {
+      // with -e, number_samples is the maximum of a run
+      jobs[i] = pi_pool_submit_target(pool, (long long) i * num_samples, num_samples, target,
+                                      kernel, generator, (runs > 1) ? print_run : NULL, &run_ids[i]);
+    }
   }
 
-  for (i = 0; i < num_threads; i++)
+  long long circle_hits = 0;
+  long long samples_used = 0;
+  double sum = 0, sum_squares = 0;
+  double weighted_variance = 0;
+  for (i = 0; i < runs; i++)
   {
-    pthread_join (tid[i], NULL);
-    circle_hits += thread_args[i].circle_hits_ret;
+    double estimate = pi_job_wait(jobs[i]);
+    double samples = (double) pi_job_samples(jobs[i]);
+
+    sum += estimate;
+    sum_squares += estimate * estimate;
+    weighted_variance += pi_job_variance(jobs[i]) * samples * samples;
+    circle_hits += pi_job_hits(jobs[i]);
+    samples_used += pi_job_samples(jobs[i]);
+    pi_job_free(jobs[i]);
   }
-  
-  //printf ("main() reporting that all %d threads have terminated\n", num_threads);
-  //printf ("global number of circle hits: %d\n", circle_hits);
-  
-  double pi = ((double) circle_hits / num_samples) * 4;
+
+  clock_gettime(CLOCK_MONOTONIC, &jobs_end);
+  get_difference(&jobs_start, &jobs_end, &jobs_diff);
+  double seconds = jobs_diff.tv_sec + jobs_diff.tv_nsec * 1e-9;
+
+  pi_pool_destroy(pool);
+
+  double pi = ((double) circle_hits / (double) samples_used) * 4;
   printf ("estimation of pi: %f\n", pi);
 
+  // variance of the estimate of all runs (weighted by their samples), as
+  // estimated by the method; variance * samples compares the methods per
+  // sample, variance * seconds per time to a given accuracy (smaller is
+  // better for both)
+  double variance = weighted_variance / ((double) samples_used * samples_used);
+
+  if (target > 0)
+  {
+    printf ("samples used: %lld, 95%% confidence interval: +- %g\n",
+            samples_used, PI_CONFIDENCE_Z * sqrt(variance));
+  }
+
+  if (generator != PI_QMC_HALTON)
+  {
+    printf ("variance of the estimate: %g, standard error: %g\n", variance, sqrt(variance));
+    printf ("variance * samples: %g, variance * seconds: %g (samples used: %lld, %.3f s)\n",
+            variance * samples_used, variance * seconds, samples_used, seconds);
+  }
+
+  // standard error of the mean of the runs, from their spread; for the
+  // randomized halton points the only error estimate there is
+  if (runs > 1)
+  {
+    double mean = sum / runs;
+    double variance = (sum_squares - runs * mean * mean) / (runs - 1);
+
+    printf ("standard error of the runs: %g\n", sqrt((variance > 0 ? variance : 0) / runs));
+  }
+
   double relative_error = ((pi - M_PI) / M_PI);
   printf ("relative error: %f\n", relative_error);
 
+  // units are samples
+  perfReport(stdout, "pi");
+
   // free heap 
-  free(tid);
-  free(thread_args);
+  free(jobs);
+  free(run_ids);
 
   //get end time
   if(clock_gettime(CLOCK_MONOTONIC, &end) != 0){
@@ -2,7 +2,11 @@
 #include <stdio.h>
 #include "random.h"
 
-#define RNG_MOD 714025
+#define RNG_MOD PR_RANDOM_MOD
+#define RNG_MUL 1366
+#define RNG_ADD 150889
+
+#define PCG_MUL 6364136223846793005ULL
 
 
 static pthread_mutex_t get_random_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -12,7 +16,7 @@ int pr_random(void)
 {
   static int state = 0;
     
-  return (state = (1366 * state + 150889) % RNG_MOD);
+  return (state = (RNG_MUL * state + RNG_ADD) % RNG_MOD);
 }
 
 double pr_random_f(double range)
@@ -25,3 +29,113 @@ double pr_random_f(double range)
   
   return ((double) pr_random_safe / (double) RNG_MOD) * range;
 }
+
+void pr_random_seed(pr_random_state *s, int seed)
+{
+  s->state = seed % RNG_MOD;
+}
+
+int pr_random_r(pr_random_state *s)
+{
+  return (s->state = (RNG_MUL * s->state + RNG_ADD) % RNG_MOD);
+}
+
+double pr_random_f_r(pr_random_state *s, double range)
+{
+  return ((double) pr_random_r(s) / (double) RNG_MOD) * range;
+}
+
+/* n steps of x -> a * x + c are again an affine map; the map of 2^k
+ * steps is the one of 2^(k-1) steps applied twice:
+ *   (a, c) o (a, c) = (a * a, a * c + c)
+ */
+void pr_random_skip(pr_random_state *s, unsigned long long n)
+{
+  long long a = RNG_MUL, c = RNG_ADD;
+  long long x = s->state;
+
+  while (n > 0)
+  {
+    if (n & 1)
+    {
+      x = (a * x + c) % RNG_MOD;
+    }
+    c = (a * c + c) % RNG_MOD;
+    a = (a * a) % RNG_MOD;
+    n >>= 1;
+  }
+
+  s->state = (int) x;
+}
+
+void pr_random_stride(unsigned long long n, int *a, int *c)
+{
+  long long a_n = 1, c_n = 0;
+  long long a_step = RNG_MUL, c_step = RNG_ADD;
+
+  // compose the maps of the set bits of n, as in pr_random_skip
+  while (n > 0)
+  {
+    if (n & 1)
+    {
+      a_n = (a_step * a_n) % RNG_MOD;
+      c_n = (a_step * c_n + c_step) % RNG_MOD;
+    }
+    c_step = (a_step * c_step + c_step) % RNG_MOD;
+    a_step = (a_step * a_step) % RNG_MOD;
+    n >>= 1;
+  }
+
+  *a = (int) a_n;
+  *c = (int) c_n;
+}
+
+void pr_pcg_seed(pr_pcg_state *s, unsigned long long seed, unsigned long long stream)
+{
+  s->state = 0;
+  s->inc = (stream << 1) | 1;
+  pr_pcg_r(s);
+  s->state += seed;
+  pr_pcg_r(s);
+}
+
+unsigned int pr_pcg_r(pr_pcg_state *s)
+{
+  unsigned long long old = s->state;
+  unsigned int xorshifted = (unsigned int) (((old >> 18) ^ old) >> 27);
+  unsigned int rot = (unsigned int) (old >> 59);
+
+  s->state = old * PCG_MUL + s->inc;
+  return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+void pr_pcg_stride(const pr_pcg_state *s, unsigned long long n,
+                   unsigned long long *a, unsigned long long *c)
+{
+  // as pr_random_stride, modulo 2^64 by the unsigned overflow
+  unsigned long long a_n = 1, c_n = 0;
+  unsigned long long a_step = PCG_MUL, c_step = s->inc;
+
+  while (n > 0)
+  {
+    if (n & 1)
+    {
+      a_n = a_step * a_n;
+      c_n = a_step * c_n + c_step;
+    }
+    c_step = a_step * c_step + c_step;
+    a_step = a_step * a_step;
+    n >>= 1;
+  }
+
+  *a = a_n;
+  *c = c_n;
+}
+
+void pr_pcg_skip(pr_pcg_state *s, unsigned long long n)
+{
+  unsigned long long a, c;
+
+  pr_pcg_stride(s, n, &a, &c);
+  s->state = a * s->state + c;
+}
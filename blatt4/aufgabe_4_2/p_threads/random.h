@@ -1,7 +1,55 @@
 #ifndef RANDOM_H
 #define RANDOM_H
 
+/* modulus of the generator, the numbers are 0 .. PR_RANDOM_MOD - 1 */
+#define PR_RANDOM_MOD 714025
+
 int pr_random(void);
 double pr_random_f(double range);
 
+/* reentrant version: every thread keeps its own state, so no lock is
+ * needed. The sequence of a state seeded with 0 is the one of pr_random.
+ */
+typedef struct
+{
+  int state;
+} pr_random_state;
+
+void pr_random_seed(pr_random_state *s, int seed);
+int pr_random_r(pr_random_state *s);
+double pr_random_f_r(pr_random_state *s, double range);
+
+/* advance s by n numbers in O(log n) steps (block jump-ahead), e.g. to
+ * the first number of the block of samples of a thread
+ */
+void pr_random_skip(pr_random_state *s, unsigned long long n);
+
+/* n steps of the generator as one step x -> (a * x + c) % PR_RANDOM_MOD,
+ * for generating several interleaved streams (leapfrog)
+ */
+void pr_random_stride(unsigned long long n, int *a, int *c);
+
+/* PCG32 (O'Neill, pcg-random.org): a 64 bit LCG with a permuted 32 bit
+ * output, period 2^64 instead of the 714025 numbers of pr_random, for
+ * runs of more than a few hundred thousand samples. Seeded with
+ * (seed, stream) like pcg32_srandom_r; the jump-ahead works like the one
+ * of pr_random.
+ */
+#define PR_PCG_SEED 42
+#define PR_PCG_STREAM 54
+
+typedef struct
+{
+  unsigned long long state;
+  unsigned long long inc;
+} pr_pcg_state;
+
+void pr_pcg_seed(pr_pcg_state *s, unsigned long long seed, unsigned long long stream);
+unsigned int pr_pcg_r(pr_pcg_state *s);
+void pr_pcg_skip(pr_pcg_state *s, unsigned long long n);
+
+/* n steps of the underlying LCG as one step state -> a * state + c */
+void pr_pcg_stride(const pr_pcg_state *s, unsigned long long n,
+                   unsigned long long *a, unsigned long long *c);
+
 #endif
@@ -0,0 +1,24 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+/* number of hits of the samples first .. first + samples - 1, sample k
+ * being the random numbers 2k and 2k + 1 of pr_random_r (seed 0), i.e.
+ * the same samples as the scalar loop.
+ *
+ * SIMD_LANES samples are processed at once: each lane steps its own
+ * stream with the stride map of the generator, in doubles, which hold
+ * the products of the LCG exactly. The hit test x^2 + y^2 <= 1 is done
+ * on the integers as r1^2 + r2^2 <= PR_RANDOM_MOD^2, without division,
+ * and counted with vector compares. On x86-64 an AVX2 version is chosen
+ * at runtime if the CPU has it.
+ */
+long long simd_circle_hits(unsigned long long first, long long samples);
+
+/* the same with pr_pcg_r (PR_PCG_SEED, PR_PCG_STREAM): the lanes step
+ * the 64 bit state of PCG32 with its stride map and permute it to the
+ * output. x and y are the upper 31 bits of the outputs and the test is
+ * x^2 + y^2 <= 2^62.
+ */
+long long simd_circle_hits_pcg(unsigned long long first, long long samples);
+
+#endif
@@ -5,35 +5,92 @@
 
 #include <pthread.h>
 
-#define RNG_MOD 714025
+/* PCG32 (O'Neill, pcg-random.org), period 2^64: the LCG of modulus
+ * 714025 repeated after 357012 samples, and every thread started it at
+ * the same state. Now all threads share one sequence, each jumps ahead
+ * to the numbers of its own block of samples.
+ */
+#define PCG_MUL 6364136223846793005ULL
+#define PCG_SEED 42
+#define PCG_STREAM 54
+
+typedef struct {
+    unsigned long long state;
+    unsigned long long inc;
+} pcg_state;
+
+typedef struct {
+    long long first;    /* first sample of the thread */
+    long long samples;  /* in: samples, out: hits */
+} thread_arg;
+
+static unsigned int pr_pcg(pcg_state *s)
+{
+    unsigned long long old = s->state;
+    unsigned int xorshifted = (unsigned int) (((old >> 18) ^ old) >> 27);
+    unsigned int rot = (unsigned int) (old >> 59);
+
+    s->state = old * PCG_MUL + s->inc;
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
 
+static void pr_pcg_seed(pcg_state *s, unsigned long long seed, unsigned long long stream)
+{
+    s->state = 0;
+    s->inc = (stream << 1) | 1;
+    pr_pcg(s);
+    s->state += seed;
+    pr_pcg(s);
+}
 
-static int pr_random(int* state)
+/* advance s by n numbers in O(log n) steps: n steps of the LCG are
+ * again one affine step state -> a * state + c (modulo 2^64)
+ */
+static void pr_pcg_skip(pcg_state *s, unsigned long long n)
 {
-    return (*state = (1366 * *state + 150889) % RNG_MOD);
+    unsigned long long a = 1, c = 0;
+    unsigned long long a_step = PCG_MUL, c_step = s->inc;
+
+    while (n > 0) {
+        if (n & 1) {
+            a = a_step * a;
+            c = a_step * c + c_step;
+        }
+        c_step = a_step * c_step + c_step;
+        a_step = a_step * a_step;
+        n >>= 1;
+    }
+
+    s->state = a * s->state + c;
 }
 
-static double pr_random_f(double range, int *state)
+static double pr_pcg_f(double range, pcg_state *s)
 {
-    return ((double) pr_random(state) / ((double) RNG_MOD)) * range;
+    return (pr_pcg(s) / 4294967296.0) * range;
 }
 
 static void* monto_carlo_thread_fn(void* arg)
 {
-    int samples = *((int*) arg);
-    int hits, i, state = 0;
+    thread_arg *targ = (thread_arg*) arg;
+    long long samples = targ->samples;
+    long long hits, i;
+    pcg_state state;
     double x, y;
+
+    /* sample k uses the numbers 2k and 2k + 1 */
+    pr_pcg_seed(&state, PCG_SEED, PCG_STREAM);
+    pr_pcg_skip(&state, 2 * (unsigned long long) targ->first);
     
     hits = 0;
     for (i = 0; i < samples; i++) {
-        x = pr_random_f(1.0, &state);
-        y = pr_random_f(1.0, &state);
+        x = pr_pcg_f(1.0, &state);
+        y = pr_pcg_f(1.0, &state);
         if (x * x + y * y < 1.0) {
             hits++;
         }
     }
 
-    *((int*) arg) = hits;
+    targ->samples = hits;
 
     return NULL;
 }
@@ -70,8 +127,9 @@ int main(int argc, char* argv[])
         fprintf(stderr, "Error: could not get clock time (clock_gettime).");
         exit(1);
     }
-    int i, num_threads, num_samples, status, hits;
-    int* thread_args;
+    int i, num_threads, status;
+    long long num_samples, hits;
+    thread_arg* thread_args;
     pthread_t* threads;
     double error, pi_calc;
 
@@ -85,7 +143,7 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
-    if ((num_samples = atoi(argv[2])) < 1) {
+    if (sscanf(argv[2], "%lld", &num_samples) != 1 || num_samples < 1) {
         fprintf(stderr, "invalid number of samples '%s'\n", argv[2]);
         return EXIT_FAILURE;
     }
@@ -104,7 +162,8 @@ int main(int argc, char* argv[])
 
     /* create threads */
     for (i = 0; i < num_threads; i++) {
-        thread_args[i] = (num_samples / num_threads) + (num_samples % num_threads) * ((i+1) / num_threads);
+        thread_args[i].first = i * (num_samples / num_threads);
+        thread_args[i].samples = (num_samples / num_threads) + (num_samples % num_threads) * ((i+1) / num_threads);
 
         status = pthread_create(&threads[i], NULL, monto_carlo_thread_fn, &thread_args[i]);
         if (status) {
@@ -121,7 +180,7 @@ int main(int argc, char* argv[])
             fprintf(stderr, "failed to join pthread (code %d)", status);
             return EXIT_FAILURE;
         }
-        hits += thread_args[i];
+        hits += thread_args[i].samples;
     }
 
     pi_calc = 4.0 * hits / num_samples;
@@ -7,13 +7,13 @@
 #define THREAD_ARG 0
 #define CIRCLE_RADIUS 1
 
-static int circle_hits = 0;
+static long long circle_hits = 0;
 
 
 typedef struct
 {
-  int samples_to_compute;
-  int circle_hits_ret;
+  long long samples_to_compute;
+  long long circle_hits_ret;
 } thread_arg;
 
 
@@ -27,14 +27,14 @@ static void *
 thread_routine (void * arg)
 {
   thread_arg *local_arg = (thread_arg *) arg;
-  int samples_to_compute = local_arg->samples_to_compute;
-  int local_circle_hits = 0;
+  long long samples_to_compute = local_arg->samples_to_compute;
+  long long local_circle_hits = 0;
    
-  int k;
+  long long k;
   for (k = 0; k < samples_to_compute; k++)
   {  
-    double x = pr_random_f(CIRCLE_RADIUS);
-    double y = pr_random_f(CIRCLE_RADIUS);
+    double x = pr_pcg_f(CIRCLE_RADIUS);
+    double y = pr_pcg_f(CIRCLE_RADIUS);
  
     if (circle_hit(x,y))
     {
@@ -59,7 +59,7 @@ main (int argc, char** argv)
    }
    
   unsigned int num_threads;
-  unsigned int num_samples;
+  unsigned long long num_samples;
   
   if (sscanf (argv[1],"%u",&num_threads) != 1)
   {
@@ -67,17 +67,17 @@ main (int argc, char** argv)
     return 1;
   }
   
-  if (sscanf (argv[2],"%u",&num_samples) != 1)
+  if (sscanf (argv[2],"%llu",&num_samples) != 1)
   {
     fprintf (stderr, "<number_samples> has to be a positive integer\n");
     return 1;
   }
    
-  printf ("start number_threads: %d ,number_samples: %d\n", num_threads, num_samples);
+  printf ("start number_threads: %u ,number_samples: %llu\n", num_threads, num_samples);
   
   // calculating number of samples per thread
-  int samples_per_thread = num_samples / num_threads;
-  int remaining_samples = num_samples % num_threads;
+  long long samples_per_thread = num_samples / num_threads;
+  long long remaining_samples = num_samples % num_threads;
 
   pthread_t *tid;
   thread_arg *thread_args; 
@@ -112,7 +112,7 @@ main (int argc, char** argv)
   //printf ("main() reporting that all %d threads have terminated\n", num_threads);
   //printf ("global number of circle hits: %d\n", circle_hits);
   
-  double pi = ((double) circle_hits / num_samples) * 4;
+  double pi = ((double) circle_hits / (double) num_samples) * 4;
   printf ("estimation of pi: %f\n", pi);
 
   double relative_error = ((pi - M_PI) / M_PI);
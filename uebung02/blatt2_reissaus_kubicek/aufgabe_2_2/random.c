@@ -4,6 +4,8 @@
 
 #define RNG_MOD 714025
 
+#define PCG_MUL 6364136223846793005ULL
+
 
 static pthread_mutex_t get_random_mutex = PTHREAD_MUTEX_INITIALIZER;
 
@@ -25,3 +27,39 @@ double pr_random_f(double range)
   
   return ((double) pr_random_safe / (double) RNG_MOD) * range;
 }
+
+void pr_pcg_seed(pr_pcg_state *s, unsigned long long seed, unsigned long long stream)
+{
+  s->state = 0;
+  s->inc = (stream << 1) | 1;
+  pr_pcg_r(s);
+  s->state += seed;
+  pr_pcg_r(s);
+}
+
+unsigned int pr_pcg_r(pr_pcg_state *s)
+{
+  unsigned long long old = s->state;
+  unsigned int xorshifted = (unsigned int) (((old >> 18) ^ old) >> 27);
+  unsigned int rot = (unsigned int) (old >> 59);
+
+  s->state = old * PCG_MUL + s->inc;
+  return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+double pr_pcg_f(double range)
+{
+  static pr_pcg_state state;
+  static int seeded = 0;
+
+  pthread_mutex_lock(&get_random_mutex);
+  if (!seeded)
+  {
+    pr_pcg_seed(&state, PR_PCG_SEED, PR_PCG_STREAM);
+    seeded = 1;
+  }
+  unsigned int pr_pcg_safe = pr_pcg_r(&state);
+  pthread_mutex_unlock(&get_random_mutex);
+
+  return (pr_pcg_safe / 4294967296.0) * range;
+}
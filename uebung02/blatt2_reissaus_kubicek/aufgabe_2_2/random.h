@@ -4,4 +4,22 @@
 int pr_random(void);
 double pr_random_f(double range);
 
+/* PCG32 (O'Neill, pcg-random.org): a 64 bit LCG with a permuted 32 bit
+ * output, period 2^64 instead of the 714025 numbers of pr_random, for
+ * runs of more than a few hundred thousand samples. pr_pcg_f draws from
+ * one state shared by all threads, like pr_random_f.
+ */
+#define PR_PCG_SEED 42
+#define PR_PCG_STREAM 54
+
+typedef struct
+{
+  unsigned long long state;
+  unsigned long long inc;
+} pr_pcg_state;
+
+void pr_pcg_seed(pr_pcg_state *s, unsigned long long seed, unsigned long long stream);
+unsigned int pr_pcg_r(pr_pcg_state *s);
+double pr_pcg_f(double range);
+
 #endif
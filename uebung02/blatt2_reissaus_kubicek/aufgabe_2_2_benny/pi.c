@@ -6,7 +6,7 @@
 
 struct interimResult {
 	int id;
-	int circleCount;
+	unsigned long long circleCount;
 	unsigned long long samples;
 };
 
@@ -28,7 +28,7 @@ int main(int argc, char *argv[])
 	int threadNum = atoi(argv[1]);
 	unsigned long long samples = strtoull(argv[2], &p, 10);
 	printf("number of threads: %d\n", threadNum);
-	printf("number of samples: %d\n", samples);
+	printf("number of samples: %llu\n", samples);
 
 	// thread ids
 	pthread_t *threadIds = malloc(sizeof(pthread_t) * threadNum);
@@ -36,8 +36,8 @@ int main(int argc, char *argv[])
 	// to save results from all threads
 	struct interimResult *results = malloc(sizeof(struct interimResult) * threadNum);
 
-	int samplesPerThread = samples/threadNum;
-	int rest = samples % threadNum;
+	unsigned long long samplesPerThread = samples/threadNum;
+	unsigned long long rest = samples % threadNum;
 
 
 	int i;
@@ -46,7 +46,7 @@ int main(int argc, char *argv[])
 
      	results[i] = (struct interimResult) {.id = i,
      			.circleCount = 0, 
-     			.samples = samplesPerThread + rest};
+     			.samples = samplesPerThread};
 
      	if(i == threadNum -1){
      		results[i].samples += rest;
@@ -55,7 +55,7 @@ int main(int argc, char *argv[])
      	pthread_create(&threadIds[i], NULL, calculateSamples, &results[i]);
     }
 
-    int sum_circleCount = 0;
+    unsigned long long sum_circleCount = 0;
     for(i = 0; i < threadNum; i++){
     	pthread_join(threadIds[i], NULL );
     	sum_circleCount += results[i].circleCount;
@@ -82,8 +82,8 @@ void *calculateSamples(void *s)
 	for (i = 0; i < res->samples; i++){
 
 		//generate coordinates for point
-		double x = pr_random_f(1);
-		double y = pr_random_f(1);		
+		double x = pr_pcg_f(1);
+		double y = pr_pcg_f(1);		
 		
 		if(isWithinCircle(x,y)){
 			res->circleCount += 1;
@@ -1,7 +1,10 @@
 #include <pthread.h>
+#include "random.h"
 
 #define RNG_MOD 714025
 
+#define PCG_MUL 6364136223846793005ULL
+
 pthread_mutex_t mut = PTHREAD_MUTEX_INITIALIZER;
 
 int pr_random(void)
@@ -17,3 +20,37 @@ double pr_random_f(double range)
 {
     return ((double) pr_random() / (double) RNG_MOD) * range;
 }
+
+void pr_pcg_seed(pr_pcg_state *s, unsigned long long seed, unsigned long long stream)
+{
+    s->state = 0;
+    s->inc = (stream << 1) | 1;
+    pr_pcg_r(s);
+    s->state += seed;
+    pr_pcg_r(s);
+}
+
+unsigned int pr_pcg_r(pr_pcg_state *s)
+{
+    unsigned long long old = s->state;
+    unsigned int xorshifted = (unsigned int) (((old >> 18) ^ old) >> 27);
+    unsigned int rot = (unsigned int) (old >> 59);
+
+    s->state = old * PCG_MUL + s->inc;
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+double pr_pcg_f(double range)
+{
+    static pr_pcg_state state;
+    static int seeded = 0;
+
+    pthread_mutex_lock(&mut);
+    if (!seeded) {
+        pr_pcg_seed(&state, PR_PCG_SEED, PR_PCG_STREAM);
+        seeded = 1;
+    }
+    unsigned int rand = pr_pcg_r(&state);
+    pthread_mutex_unlock(&mut);
+    return ((double) rand / 4294967296.0) * range;
+}